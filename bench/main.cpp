@@ -0,0 +1,490 @@
+#include "raylib.h"
+#include "box2d/box2d.h"
+#include "car.h"
+#include "edit_history.h"
+#include "job_system.h"
+#include "level.h"
+#include "level_data.h"
+#include "node_grid.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <list>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//----------------------------------------------------------------------------------
+// Benchmark suite for the simulation side of the game. Every case runs its warm-up
+// repetitions, then the measured ones, and reports min/median/mean/max per case:
+//
+//   ldtk_parse, binary_load     whole project load, every level decoded
+//   level_build, level_reset    Level::Build and Level::Destroy for each shipped level
+//                               (the Box2D part of SceneManager::Load/Reset)
+//   add_joint                   N beams added to a fresh level, N = 10..10k
+//   edit_undo_redo              undo + redo of one beam placement on an N beam bridge
+//   step                        one physics step against bridge size and worker count
+//   car_spawn, car_despawn      Car::Spawn/Despawn in an empty world
+//   pick_grid, pick_list        node picking against node count, grid and linear scan
+//
+// usage: NextJam_bench [--warmup N] [--reps N] [--filter TEXT] [--json FILE]
+//                      [--levels levels.ldtk|stress.bin] [--steps N] [--max-workers N] [--queries N]
+//
+// --json writes every case with its raw samples, for tracking regressions across commits.
+//----------------------------------------------------------------------------------
+
+#if !defined(NEXTJAM_BENCH_LEVELS)
+#define NEXTJAM_BENCH_LEVELS "levels.ldtk"
+#endif
+
+static constexpr int nodesPerDeck = 101;
+static constexpr float nodeSpacing = 30.0f;
+static constexpr float deckSpacing = 40.0f;
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions
+{
+    int warmup = 2;
+    int reps = 10;
+    int steps = 300;
+    int maxWorkers = static_cast<int>(std::thread::hardware_concurrency());
+    int queryCount = 100000;
+    const char* filter = nullptr;
+    const char* jsonFile = nullptr;
+    std::string levels = NEXTJAM_BENCH_LEVELS;
+};
+
+struct BenchCase
+{
+    std::string name;
+    std::vector<std::pair<std::string, int>> params;
+    const char* unit = "ms";
+    std::vector<double> samples;
+};
+
+class BenchSuite
+{
+public:
+    explicit BenchSuite(const BenchOptions& options) : options(options) {}
+
+    bool Enabled(const char* name) const
+    {
+        return !options.filter || strstr(name, options.filter);
+    }
+
+    // `measure` runs one repetition and returns its time in `unit`, so per-repetition
+    // setup stays outside the measurement
+    void Run(const char* name, std::vector<std::pair<std::string, int>> params, const char* unit,
+        const std::function<double()>& measure)
+    {
+        if (!Enabled(name))
+        {
+            return;
+        }
+        for (int i = 0; i < options.warmup; i++)
+        {
+            measure();
+        }
+        BenchCase result { name, std::move(params), unit, {} };
+        for (int i = 0; i < options.reps; i++)
+        {
+            result.samples.push_back(measure());
+        }
+        print(result);
+        cases.emplace_back(std::move(result));
+    }
+
+    bool WriteJson(const char* fileName) const
+    {
+        FILE* file = fopen(fileName, "w");
+        if (!file)
+        {
+            printf("cannot write '%s'\n", fileName);
+            return false;
+        }
+        fprintf(file, "{\n  \"warmup\": %i,\n  \"reps\": %i,\n  \"hardware_threads\": %u,\n  \"cases\": [\n",
+            options.warmup, options.reps, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < cases.size(); i++)
+        {
+            const BenchCase& bench = cases[i];
+            Stats stats = summarize(bench.samples);
+            fprintf(file, "    { \"name\": \"%s\", \"params\": {", bench.name.c_str());
+            for (size_t p = 0; p < bench.params.size(); p++)
+            {
+                fprintf(file, "%s\"%s\": %i", p? ", " : " ", bench.params[p].first.c_str(), bench.params[p].second);
+            }
+            fprintf(file, "%s}, \"unit\": \"%s\", \"min\": %.6f, \"median\": %.6f, \"mean\": %.6f, \"max\": %.6f, \"samples\": [",
+                bench.params.empty()? "" : " ", bench.unit, stats.min, stats.median, stats.mean, stats.max);
+            for (size_t s = 0; s < bench.samples.size(); s++)
+            {
+                fprintf(file, "%s%.6f", s? ", " : "", bench.samples[s]);
+            }
+            fprintf(file, "] }%s\n", (i + 1 < cases.size())? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+        fclose(file);
+        return true;
+    }
+private:
+    struct Stats
+    {
+        double min = 0.0, median = 0.0, mean = 0.0, max = 0.0;
+    };
+
+    static Stats summarize(std::vector<double> samples)
+    {
+        Stats stats;
+        if (samples.empty())
+        {
+            return stats;
+        }
+        std::sort(samples.begin(), samples.end());
+        stats.min = samples.front();
+        stats.max = samples.back();
+        stats.median = samples[samples.size()/2];
+        for (double sample : samples) stats.mean += sample;
+        stats.mean /= samples.size();
+        return stats;
+    }
+
+    void print(const BenchCase& bench) const
+    {
+        std::string label = bench.name;
+        for (auto& param : bench.params)
+        {
+            label += " " + param.first + "=" + std::to_string(param.second);
+        }
+        Stats stats = summarize(bench.samples);
+        printf("%-40s %12.4f %12.4f %12.4f %s\n", label.c_str(), stats.min, stats.median, stats.max, bench.unit);
+    }
+
+    const BenchOptions& options;
+    std::vector<BenchCase> cases;
+};
+
+static double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Decks of nodes spanning a chasm, every neighbour pair joined by a beam
+static scene::LevelData MakeBridgeLevel(int deckCount)
+{
+    scene::LevelData data;
+    data.name = "bench_bridge";
+    data.size = { nodesPerDeck*nodeSpacing + 200.0f, deckCount*deckSpacing + 200.0f };
+    data.statics.push_back({ 0.0f, data.size.y - 40.0f, 100.0f, 40.0f });
+    data.statics.push_back({ data.size.x - 100.0f, data.size.y - 40.0f, 100.0f, 40.0f });
+    for (int deck = 0; deck < deckCount; deck++)
+    {
+        for (int i = 0; i < nodesPerDeck; i++)
+        {
+            data.nodes.push_back({ 100.0f + i*nodeSpacing, 100.0f + deck*deckSpacing, 8.0f, 8.0f });
+        }
+    }
+    return data;
+}
+
+static void BuildBridge(scene::Level& level, int deckCount, int beamCount = -1)
+{
+    int added = 0;
+    for (int deck = 0; deck < deckCount; deck++)
+    {
+        for (int i = 0; i + 1 < nodesPerDeck; i++)
+        {
+            if ((beamCount >= 0) && (added++ >= beamCount)) return;
+            level.AddJoint(deck*nodesPerDeck + i, deck*nodesPerDeck + i + 1);
+        }
+    }
+}
+
+static void BenchProject(BenchSuite& suite, const BenchOptions& options)
+{
+    std::string binary = options.levels.substr(0, options.levels.rfind('.')) + ".bin";
+    // A compiled project (e.g. from NextJam_levelgen) skips the LDtk parse
+    bool compiled = (options.levels.size() > 4) && (options.levels.compare(options.levels.size() - 4, 4, ".bin") == 0);
+    scene::LevelProject probe;
+    if (compiled? !probe.LoadFromBinary(options.levels) : !probe.LoadFromLdtk(options.levels))
+    {
+        printf("cannot load '%s', skipping the shipped level cases (use --levels)\n", options.levels.c_str());
+        return;
+    }
+
+    if (!compiled)
+    {
+        suite.Run("ldtk_parse", {}, "ms", [&options]() {
+            auto start = Clock::now();
+            scene::LevelProject project;
+            project.LoadFromLdtk(options.levels);
+            return ElapsedMs(start);
+        });
+    }
+    if (FileExists(binary.c_str()))
+    {
+        suite.Run("binary_load", {}, "ms", [&binary]() {
+            auto start = Clock::now();
+            scene::LevelProject project;
+            project.LoadFromBinary(binary);
+            for (int i = 0; i < project.Count(); i++)
+            {
+                project.Get(i);
+            }
+            return ElapsedMs(start);
+        });
+    }
+
+    core::JobSystem jobSystem(core::JobSystem::DefaultWorkerCount());
+    for (int index = 0; index < probe.Count(); index++)
+    {
+        const scene::LevelData& data = probe.Get(index);
+        scene::Level level;
+        level.SetJobSystem(&jobSystem);
+        suite.Run("level_build", { { "level", index } }, "ms", [&level, &data]() {
+            level.Destroy();
+            auto start = Clock::now();
+            level.Build(data);
+            return ElapsedMs(start);
+        });
+        suite.Run("level_reset", { { "level", index } }, "ms", [&level, &data]() {
+            level.Build(data);
+            auto start = Clock::now();
+            level.Destroy();
+            return ElapsedMs(start);
+        });
+    }
+}
+
+static void BenchAddJoint(BenchSuite& suite)
+{
+    constexpr int maxBeams = 10000;
+    scene::LevelData data = MakeBridgeLevel(maxBeams/(nodesPerDeck - 1));
+    for (int beamCount : { 10, 100, 1000, 10000 })
+    {
+        scene::Level level;
+        suite.Run("add_joint", { { "beams", beamCount } }, "ms", [&]() {
+            level.Build(data);
+            auto start = Clock::now();
+            BuildBridge(level, maxBeams/(nodesPerDeck - 1), beamCount);
+            return ElapsedMs(start);
+        });
+    }
+}
+
+// Should stay flat across bridge sizes: an edit only touches its own beam and welds
+static void BenchEditHistory(BenchSuite& suite)
+{
+    constexpr int maxBeams = 10000;
+    constexpr int batch = 100;
+    scene::LevelData data = MakeBridgeLevel(maxBeams/(nodesPerDeck - 1));
+    for (int beamCount : { 10, 100, 1000, 10000 })
+    {
+        scene::Level level;
+        level.Build(data);
+        BuildBridge(level, maxBeams/(nodesPerDeck - 1), beamCount);
+        scene::EditHistory history;
+        history.AddJoint(level, level.Nodes().HandleAt(0), level.Nodes().HandleAt(2));
+        suite.Run("edit_undo_redo", { { "beams", beamCount } }, "us", [&]() {
+            auto start = Clock::now();
+            for (int i = 0; i < batch; i++)
+            {
+                history.Undo(level);
+                history.Redo(level);
+            }
+            return ElapsedMs(start)*1000.0/batch;
+        });
+    }
+}
+
+static void BenchStep(BenchSuite& suite, const BenchOptions& options)
+{
+    for (int deckCount : { 1, 4, 10, 40 })
+    {
+        scene::LevelData data = MakeBridgeLevel(deckCount);
+        for (int workers = 1; workers <= options.maxWorkers; workers *= 2)
+        {
+            core::JobSystem jobSystem(workers);
+            scene::Level level;
+            level.SetJobSystem(&jobSystem);
+            level.Build(data);
+            BuildBridge(level, deckCount);
+            // One repetition is the mean over --steps steps of the same settling bridge
+            suite.Run("step", { { "beams", deckCount*(nodesPerDeck - 1) }, { "workers", workers } }, "ms", [&]() {
+                auto start = Clock::now();
+                for (int i = 0; i < options.steps; i++)
+                {
+                    level.Step(scene::Level::fixedTimeStep, scene::Level::defaultSubStepCount);
+                }
+                return ElapsedMs(start)/options.steps;
+            });
+        }
+    }
+}
+
+static void BenchCar(BenchSuite& suite)
+{
+    constexpr int batch = 100;
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    worldDef.gravity.y = 9.8f * 50;
+    b2WorldId worldId = b2CreateWorld(&worldDef);
+    std::vector<Car> cars(batch);
+    auto spawnAll = [&]() {
+        for (auto& car : cars)
+        {
+            car.Spawn(worldId, { 100.0f, 100.0f }, 10.0f, 25.0f, 0.7f, 90000.0f);
+        }
+    };
+    auto despawnAll = [&]() {
+        for (auto& car : cars)
+        {
+            car.Despawn();
+        }
+    };
+    suite.Run("car_spawn", {}, "us", [&]() {
+        auto start = Clock::now();
+        spawnAll();
+        double us = ElapsedMs(start)*1000.0/batch;
+        despawnAll();
+        return us;
+    });
+    suite.Run("car_despawn", {}, "us", [&]() {
+        spawnAll();
+        auto start = Clock::now();
+        despawnAll();
+        return ElapsedMs(start)*1000.0/batch;
+    });
+    b2DestroyWorld(worldId);
+}
+
+// Picking rectangles laid out like bridge decks, grown by the pick margin
+static std::vector<Rectangle> MakePickRects(int nodeCount)
+{
+    std::vector<Rectangle> rects;
+    rects.reserve(nodeCount);
+    float margin = scene::Level::nodePickMargin;
+    for (int i = 0; i < nodeCount; i++)
+    {
+        float x = 100.0f + (i % nodesPerDeck)*nodeSpacing;
+        float y = 100.0f + (i / nodesPerDeck)*deckSpacing;
+        rects.push_back({ x - margin, y - margin, 8.0f + margin, 8.0f + margin });
+    }
+    return rects;
+}
+
+template <typename Query>
+static double MeasureQueryNs(const std::vector<Vector2>& points, Query query)
+{
+    int hits = 0;
+    auto start = Clock::now();
+    for (auto& point : points)
+    {
+        hits += (query(point) >= 0) ? 1 : 0;
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    // Keep the loop from being optimised away
+    if (hits < 0) printf("%i", hits);
+    return elapsed.count()/points.size();
+}
+
+static void BenchPicking(BenchSuite& suite, const BenchOptions& options)
+{
+    int queryCount = options.queryCount;
+    std::mt19937 random(1234);
+    for (int nodeCount : { 10, 100, 1000, 10000, 100000 })
+    {
+        std::vector<Rectangle> rects = MakePickRects(nodeCount);
+        std::list<Rectangle> list(rects.begin(), rects.end());
+
+        // Hover samples the whole level, mostly misses; pick aims at a random node
+        Vector2 max = { 0.0f, 0.0f };
+        for (auto& rect : rects)
+        {
+            max = { std::max(max.x, rect.x + rect.width), std::max(max.y, rect.y + rect.height) };
+        }
+        std::uniform_real_distribution<float> xs(0.0f, max.x + 100.0f);
+        std::uniform_real_distribution<float> ys(0.0f, max.y + 100.0f);
+        std::uniform_int_distribution<int> nodes(0, nodeCount - 1);
+        std::vector<Vector2> hoverPoints(queryCount);
+        std::vector<Vector2> pickPoints(queryCount);
+        for (int i = 0; i < queryCount; i++)
+        {
+            hoverPoints[i] = { xs(random), ys(random) };
+            const Rectangle& rect = rects[nodes(random)];
+            pickPoints[i] = { rect.x + rect.width*0.5f, rect.y + rect.height*0.5f };
+        }
+
+        scene::NodeGrid grid;
+        suite.Run("pick_grid_build", { { "nodes", nodeCount } }, "us", [&]() {
+            auto start = Clock::now();
+            grid.Build(rects);
+            return ElapsedMs(start)*1000.0;
+        });
+
+        auto gridQuery = [&grid](Vector2 point) { return grid.Query(point); };
+        auto listQuery = [&list](Vector2 point) {
+            int index = 0;
+            for (auto& rect : list)
+            {
+                if (CheckCollisionPointRec(point, rect)) return index;
+                index++;
+            }
+            return -1;
+        };
+        // The linear scan is only sampled at large counts, it would dominate the run
+        std::vector<Vector2> listHover(hoverPoints.begin(), hoverPoints.begin() + std::min(queryCount, 1000));
+        std::vector<Vector2> listPick(pickPoints.begin(), pickPoints.begin() + std::min(queryCount, 1000));
+        suite.Run("pick_grid_hover", { { "nodes", nodeCount } }, "ns", [&]() { return MeasureQueryNs(hoverPoints, gridQuery); });
+        suite.Run("pick_grid", { { "nodes", nodeCount } }, "ns", [&]() { return MeasureQueryNs(pickPoints, gridQuery); });
+        suite.Run("pick_list_hover", { { "nodes", nodeCount } }, "ns", [&]() { return MeasureQueryNs(listHover, listQuery); });
+        suite.Run("pick_list", { { "nodes", nodeCount } }, "ns", [&]() { return MeasureQueryNs(listPick, listQuery); });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    SetTraceLogLevel(LOG_WARNING);
+    BenchOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--warmup") == 0) && (i + 1 < argc)) options.warmup = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--reps") == 0) && (i + 1 < argc)) options.reps = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--filter") == 0) && (i + 1 < argc)) options.filter = argv[++i];
+        else if ((strcmp(argv[i], "--json") == 0) && (i + 1 < argc)) options.jsonFile = argv[++i];
+        else if ((strcmp(argv[i], "--levels") == 0) && (i + 1 < argc)) options.levels = argv[++i];
+        else if ((strcmp(argv[i], "--steps") == 0) && (i + 1 < argc)) options.steps = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--max-workers") == 0) && (i + 1 < argc)) options.maxWorkers = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--queries") == 0) && (i + 1 < argc)) options.queryCount = atoi(argv[++i]);
+        else
+        {
+            printf("usage: %s [--warmup N] [--reps N] [--filter TEXT] [--json FILE] [--levels levels.ldtk] [--steps N] [--max-workers N] [--queries N]\n", argv[0]);
+            return 1;
+        }
+    }
+    options.warmup = std::max(options.warmup, 0);
+    options.reps = std::max(options.reps, 1);
+    options.steps = std::max(options.steps, 1);
+    options.maxWorkers = std::max(options.maxWorkers, 1);
+    options.queryCount = std::max(options.queryCount, 1);
+
+    BenchSuite suite(options);
+    printf("%-40s %12s %12s %12s\n", "case", "min", "median", "max");
+    BenchProject(suite, options);
+    BenchAddJoint(suite);
+    BenchEditHistory(suite);
+    BenchStep(suite, options);
+    BenchCar(suite);
+    BenchPicking(suite, options);
+
+    if (options.jsonFile && !suite.WriteJson(options.jsonFile))
+    {
+        return 1;
+    }
+    return 0;
+}
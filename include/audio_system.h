@@ -0,0 +1,65 @@
+#pragma once
+#include "raylib.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "resource_pack.h"
+
+namespace core
+{
+    using EffectId = int;
+    using StreamId = int;
+
+    // All game audio. One-shot effects play from a pool of sound aliases per effect, so
+    // quick repeats overlap instead of restarting each other. Streams are refilled on
+    // a dedicated thread (on the main thread on web, from Update); every Music call goes
+    // through here, under the same lock as the refills.
+    class AudioSystem
+    {
+    public:
+        static AudioSystem* getInstance();
+        static void cleanup();
+
+        EffectId LoadEffect(const std::string& path, int voices = defaultVoices);
+        EffectId LoadEffect(Wave wave, int voices = defaultVoices);
+        void PlayEffect(EffectId id);
+        // inMemory reads the whole (compressed) file once and decodes it from memory,
+        // refills then never touch the disk. Packed streams always decode from the pack.
+        StreamId LoadStream(const std::string& path, bool inMemory = false);
+        // Keeps file data read elsewhere (ResourcePack::Read) alive with the stream, fileType as ".wav"
+        StreamId LoadStream(const std::string& fileType, AssetData file);
+        void PlayStream(StreamId id);
+        void StopStream(StreamId id);
+        void Update();
+
+        static constexpr int defaultVoices = 4;
+        static constexpr int refillIntervalMs = 10;
+    private:
+        AudioSystem();
+        ~AudioSystem();
+        void refillLoop();
+        void refill();
+
+        struct Effect
+        {
+            Sound sound;
+            std::vector<Sound> aliases;   // sound itself is voice 0
+            int next = 0;
+        };
+
+        struct Stream
+        {
+            Music music;
+            AssetData file;
+        };
+
+        inline static AudioSystem* instance = nullptr;
+        std::vector<Effect> effects;
+        std::vector<Stream> streams;
+        std::mutex streamMutex;
+        std::atomic<bool> running { true };
+        std::thread refillThread;
+    };
+}
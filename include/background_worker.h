@@ -0,0 +1,48 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace core
+{
+    // One long-lived thread for loading work that must stay off the main thread (level
+    // preloads, spare level builds), run in submission order. Submit never blocks, and
+    // a future dropped before its work is done does not either: the result is then freed
+    // on the worker. The web build has no threads, the work runs when its future is
+    // waited on.
+    class BackgroundWorker
+    {
+    public:
+        BackgroundWorker();
+        ~BackgroundWorker();
+        BackgroundWorker(const BackgroundWorker&) = delete;
+        BackgroundWorker& operator=(const BackgroundWorker&) = delete;
+
+        template <typename Work>
+        auto Submit(Work work) -> std::future<decltype(work())>
+        {
+            using Result = decltype(work());
+#if defined(PLATFORM_WEB)
+            return std::async(std::launch::deferred, std::move(work));
+#else
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::move(work));
+            std::future<Result> result = task->get_future();
+            push([task]() { (*task)(); });
+            return result;
+#endif
+        }
+    private:
+        void push(std::function<void()> job);
+        void run();
+
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<std::function<void()>> jobs;
+        bool running = true;
+    };
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "bridge_evaluator.h"
+#include "level_data.h"
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace scene
+{
+    struct DesignerOptions
+    {
+        int population = 48;
+        int generations = 40;
+        int eliteCount = 2;            // best designs carried over unchanged
+        int tournamentSize = 3;
+        float crossoverRate = 0.9f;
+        float mutationRate = 0.0f;     // per candidate beam, 0 flips two beams per design on average
+        float maxSpan = 0.0f;          // longest beam considered, 0 picks 2.5x the median node spacing
+        float stressWeight = 0.05f;    // cost of a pixel of peak weld stretch, in beams
+        int stallGenerations = 12;     // stop once the best cost has not improved for this long
+        unsigned int seed = 1;
+        EvaluatorOptions evaluator = { 20.0f, 3.0f, true, 0 };
+    };
+
+    struct DesignCandidate
+    {
+        BridgeDesign design;
+        BridgeResult result;
+        float cost = 0.0f;
+    };
+
+    struct DesignerStats
+    {
+        int generations = 0;
+        int evaluations = 0;           // simulated runs, cache hits excluded
+        int cacheHits = 0;
+        long long steps = 0;           // physics steps over every run
+        double seconds = 0.0;
+        int threadCount = 1;
+    };
+
+    // Searches the joint sets a level's nodes allow for the cheapest bridge that gets
+    // the car through: a genetic algorithm over "which candidate beams exist", each
+    // generation scored in parallel headless worlds by BridgeEvaluator, then a greedy
+    // pass that drops beams from the best passing design while it still passes.
+    // Cost is the beam count plus stressWeight * peak weld stretch for passing designs;
+    // failing ones rank behind every passing one, ordered by how far the car got.
+    class BridgeDesigner
+    {
+    public:
+        explicit BridgeDesigner(const LevelData& level, DesignerOptions options = {});
+
+        DesignCandidate Run();
+        const std::vector<std::pair<int, int>>& Candidates() const { return candidates; }
+        const DesignerStats& Stats() const { return stats; }
+    private:
+        using Genome = std::vector<uint8_t>;
+
+        void findCandidates();
+        Genome seedGenome() const;
+        BridgeDesign decode(const Genome& genome) const;
+        float cost(const BridgeResult& result, int beams) const;
+        std::vector<DesignCandidate> evaluate(const std::vector<Genome>& genomes);
+        DesignCandidate prune(Genome genome, DesignCandidate best);
+
+        const LevelData& level;
+        DesignerOptions options;
+        BridgeEvaluator evaluator;
+        std::vector<std::pair<int, int>> candidates;
+        std::map<Genome, DesignCandidate> cache;
+        DesignerStats stats;
+    };
+}
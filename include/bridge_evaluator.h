@@ -0,0 +1,49 @@
+#pragma once
+#include "level.h"
+#include "level_data.h"
+#include <utility>
+#include <vector>
+
+namespace scene
+{
+    // A candidate bridge: node index pairs in the order AddJoint would connect them
+    struct BridgeDesign
+    {
+        std::vector<std::pair<int, int>> joints;
+    };
+
+    struct BridgeResult
+    {
+        bool valid = false;          // false when a joint references a missing node
+        LevelState outcome = LevelState::PLAYING;
+        float timeToGoal = 0.0f;     // simulated seconds until the outcome or the timeout
+        int steps = 0;
+        float progress = 0.0f;       // furthest the car got towards the goal, 0 at the spawn, 1 in it
+        float peakJointError = 0.0f; // largest weld stretch seen, when measured
+    };
+
+    struct EvaluatorOptions
+    {
+        float timeout = 30.0f;       // simulated seconds before a run counts as failed
+        float stallTimeout = 0.0f;   // fail once the car made no progress for this long, 0 waits for the timeout
+        bool measureJointError = false;
+        int threadCount = 0;         // 0 uses every hardware thread
+    };
+
+    // Scores bridges in independent single-threaded b2Worlds, one per evaluator thread.
+    // The level data is shared read-only between the threads.
+    class BridgeEvaluator
+    {
+    public:
+        explicit BridgeEvaluator(const LevelData& level, EvaluatorOptions options = {});
+
+        BridgeResult Evaluate(const BridgeDesign& design) const;
+        std::vector<BridgeResult> EvaluateAll(const std::vector<BridgeDesign>& designs) const;
+        int GetThreadCount() const;
+    private:
+        BridgeResult run(Level& level, const BridgeDesign& design) const;
+
+        const LevelData& level;
+        EvaluatorOptions options;
+    };
+}
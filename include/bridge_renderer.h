@@ -0,0 +1,38 @@
+#pragma once
+#include "raylib.h"
+#include "box2d/math_functions.h"
+
+namespace scene
+{
+    class EntityStore;
+
+    // Collects the solid-colour triangles of nodes and beams into one dynamic mesh and
+    // submits them with a single draw call. Colours are per vertex, so everything shares
+    // the default material. GPU buffers are created on the first Draw and grow as needed.
+    class BridgeRenderer
+    {
+    public:
+        BridgeRenderer() = default;
+        ~BridgeRenderer();
+        BridgeRenderer(const BridgeRenderer&) = delete;
+        BridgeRenderer& operator=(const BridgeRenderer&) = delete;
+
+        void Begin();
+        void AddBox(b2Transform transform, b2Vec2 extent, Color color);
+        void AddRectangleLines(Rectangle rect, Color color);
+        void AddDot(Vector2 center, float radius, Color color);
+        void Draw();
+
+        int GetVertexCount() const { return vertexCount; }
+    private:
+        void reserve(int count);
+        void addVertex(float x, float y, Color color);
+        void addQuad(Vector2 a, Vector2 b, Vector2 c, Vector2 d, Color color);
+
+        Mesh mesh = { };
+        Material material = { };
+        bool materialLoaded = false;
+        int capacity = 0;
+        int vertexCount = 0;
+    };
+}
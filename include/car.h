@@ -9,12 +9,17 @@ class Car
 
 		void Spawn( b2WorldId worldId, b2Vec2 position, float scale, float hertz, float dampingRatio, float torque);
 		void Despawn();
-		void Draw();
+		void Draw(float alpha = 1.0f);
+		void StorePreviousTransforms();
 		void SetSpeed( float speed );
 		void SetTorque( float torque );
 		void SetHertz( float hertz );
 		void SetDampingRadio( float dampingRatio );
 		Vector2 GetPosition();
+		bool IsSpawned() const { return m_isSpawned; }
+		b2BodyId GetChassisId() const { return m_chassisId; }
+		b2BodyId GetRearWheelId() const { return m_rearWheelId; }
+		b2BodyId GetFrontWheelId() const { return m_frontWheelId; }
 
 	private:
 		b2BodyId m_chassisId;
@@ -26,4 +31,7 @@ class Car
 		b2Vec2 boxExtent;
 		b2Circle circle;
 		b2Vec2 position;
+		b2Transform m_previousChassis;
+		b2Transform m_previousRearWheel;
+		b2Transform m_previousFrontWheel;
 };
@@ -1,5 +1,7 @@
 #pragma once
+#include <chrono>
 #include <vector>
+#include <memory>
 #include "raylib.h"
 
 namespace core
@@ -31,6 +33,10 @@ namespace core
     static constexpr int gameScreenHeight = 135 * scaleGameScreen;
     constexpr int FIXED_FRAME_RATE = 60;
 
+    class BackgroundWorker;
+    class JobSystem;
+    class StartupLoader;
+
     class Core
     {
     public:
@@ -50,6 +56,8 @@ namespace core
         bool AcceptPressed();
 
         bool IsPaused() { return gameState == GameState::Paused; }
+        JobSystem* GetJobSystem() { return jobSystem.get(); }
+        BackgroundWorker* GetBackgroundWorker() { return backgroundWorker.get(); }
 
         static void CenterWindow();
         bool isTouch();
@@ -70,6 +78,10 @@ namespace core
         int currentGesture = GESTURE_NONE;
         int lastGesture = GESTURE_NONE;
         Shader postShader;
+        std::unique_ptr<JobSystem> jobSystem;
+        std::unique_ptr<BackgroundWorker> backgroundWorker;   // after jobSystem: its work may use it
+        std::unique_ptr<StartupLoader> startup;      // until the first frame is reported
+        std::chrono::steady_clock::time_point startupBegin;
 
         Vector2 touchPosition = { 0, 0 };
         Vector2 touchRightPosition = { 0, 0 };
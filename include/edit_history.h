@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "level.h"
+
+namespace scene
+{
+    // Undo/redo of the beams the player places and removes, applied straight to the live
+    // world: one beam body and its two welds are created or destroyed per edit, so an
+    // edit costs the same whatever the bridge size. Edits name beams by an id of their
+    // own, so a beam recreated by an undo keeps its place in the history.
+    class EditHistory
+    {
+    public:
+        EntityHandle AddJoint(Level& level, EntityHandle nodeA, EntityHandle nodeB);
+        bool RemoveJoint(Level& level, EntityHandle beam);
+        bool Undo(Level& level);
+        bool Redo(Level& level);
+        // The level was rebuilt: every handle the history holds is gone
+        void Clear();
+
+        bool CanUndo() const { return cursor > 0; }
+        bool CanRedo() const { return cursor < edits.size(); }
+        size_t GetMemoryUsage() const;
+    private:
+        // 12 bytes per edit; nodes never change during a level, dense indices name them
+        struct Edit
+        {
+            uint32_t nodeA;
+            uint32_t nodeB;
+            uint32_t beam : 31;
+            uint32_t removed : 1;
+        };
+
+        uint32_t beamId(EntityHandle beam);
+        bool place(Level& level, const Edit& edit);
+        bool remove(Level& level, const Edit& edit);
+        void push(Edit edit);
+
+        std::vector<Edit> edits;
+        size_t cursor = 0;                      // edits before it are applied
+        std::vector<EntityHandle> beams;        // live handle of every beam id
+        std::vector<uint32_t> beamIdBySlot;     // beam id of the beam in each store slot
+    };
+}
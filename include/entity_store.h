@@ -0,0 +1,63 @@
+#pragma once
+#include "raylib.h"
+#include "box2d/box2d.h"
+#include <cstdint>
+#include <vector>
+
+namespace scene
+{
+    // Names an entity in an EntityStore. The generation changes every time a slot is
+    // reused, so a handle to a removed entity never resolves to its replacement.
+    struct EntityHandle
+    {
+        static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+        uint32_t index = invalidIndex;
+        uint32_t generation = 0;
+
+        bool IsValid() const { return index != invalidIndex; }
+        bool operator==(const EntityHandle& other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+    };
+
+    // Pooled structure-of-arrays storage. Live entities are kept densely packed in
+    // [0, Size()) so the per-frame loops walk plain arrays; removal swaps the last
+    // entity into the hole and handles are remapped through a slot table.
+    class EntityStore
+    {
+    public:
+        EntityHandle Create(Vector2 position, b2Vec2 extent, b2BodyId bodyId = b2_nullBodyId);
+        bool Destroy(EntityHandle handle);
+        void Clear();
+        bool IsAlive(EntityHandle handle) const { return Find(handle) >= 0; }
+        int Find(EntityHandle handle) const;
+        int FindSlot(uint32_t slot) const;
+        int Size() const { return static_cast<int>(positions.size()); }
+        bool Empty() const { return positions.empty(); }
+
+        EntityHandle HandleAt(int index) const { return owners[index]; }
+        Vector2 Position(int index) const { return positions[index]; }
+        b2Vec2 Extent(int index) const { return extents[index]; }
+        b2BodyId BodyId(int index) const { return bodyIds[index]; }
+        bool HasBody(int index) const { return !B2_IS_NULL(bodyIds[index]); }
+        Rectangle Bounds(int index) const;
+        b2Transform Transform(int index) const { return transforms[index]; }
+        void SetTransform(int index, b2Transform transform) { transforms[index] = transform; }
+        b2Transform PreviousTransform(int index) const { return previousTransforms[index]; }
+        void SnapshotTransforms() { previousTransforms = transforms; }
+
+        const std::vector<b2BodyId>& BodyIds() const { return bodyIds; }
+        const std::vector<b2Transform>& Transforms() const { return transforms; }
+    private:
+        std::vector<Vector2> positions;
+        std::vector<b2Vec2> extents;
+        std::vector<b2BodyId> bodyIds;
+        std::vector<b2Transform> transforms;            // last known body transform
+        std::vector<b2Transform> previousTransforms;    // the same before the last step
+        std::vector<EntityHandle> owners;
+
+        std::vector<uint32_t> slotDense;
+        std::vector<uint32_t> slotGeneration;
+        std::vector<uint32_t> freeSlots;
+    };
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "job_system.h"
+#include "level_data.h"
+
+namespace scene
+{
+    enum class InputType : uint8_t {
+        SelectNode,     // a: dense node index
+        AddJoint,       // a, b: dense node indices passed to Level::AddJoint
+        Cancel,         // right click drops the selection
+        MoveCar,
+        Restart,        // rebuilds the current level
+        ChangeLevel,    // a: level index that was loaded
+        SubSteps,       // a: sub-step count the adaptive controller switched to
+        RemoveJoint,    // a: dense beam index, removed through the edit history
+        Undo,           // the last beam edit was undone
+        Redo
+    };
+
+    // One gameplay input, applied after `step` physics steps of the level it belongs to
+    struct InputEvent {
+        uint32_t step = 0;
+        InputType type = InputType::MoveCar;
+        int32_t a = -1;
+        int32_t b = -1;
+    };
+
+    // Every input of a session tagged with the physics step it happened on, plus the
+    // body state it ended in. Inputs only ever land between two Level::Step calls, so
+    // stepping a fresh level to each tag and applying the input reproduces the session.
+    class InputRecording
+    {
+    public:
+        void Begin(int level);
+        void Record(int step, InputType type, int a = -1, int b = -1);
+        void Finish(int level, int step, uint64_t checksum);
+        bool Save(const std::string& path) const;
+        bool Load(const std::string& path);
+
+        int GetStartLevel() const { return startLevel; }
+        int GetFinalLevel() const { return finalLevel; }
+        int GetFinalStep() const { return finalStep; }
+        uint64_t GetFinalChecksum() const { return finalChecksum; }
+        const std::vector<InputEvent>& Events() const { return events; }
+    private:
+        int startLevel = 0;
+        int finalLevel = 0;
+        int finalStep = 0;
+        uint64_t finalChecksum = 0;
+        std::vector<InputEvent> events;
+    };
+
+    struct ReplayResult
+    {
+        bool valid = false;          // false when an event references a missing level
+        int finalLevel = 0;
+        int finalStep = 0;
+        int totalSteps = 0;          // physics steps over every level of the session
+        uint64_t checksum = 0;
+        bool matches = false;
+    };
+
+    // Plays a recording back on headless levels as fast as they step
+    ReplayResult ReplayInputs(const LevelProject& project, const InputRecording& recording, core::JobSystem* jobs = nullptr);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "box2d/types.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace core
+{
+    // Small work-stealing thread pool that implements Box2D's task interface.
+    // workerCount counts the calling thread, which helps out while it waits in FinishTask,
+    // so a pool of N workers spawns N - 1 threads. Only one thread may step worlds
+    // attached to the same pool at a time.
+    class JobSystem
+    {
+    public:
+        explicit JobSystem(int workerCount);
+        ~JobSystem();
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        int GetWorkerCount() const { return workerCount; }
+        void ConfigureWorld(b2WorldDef& worldDef);
+
+        static int DefaultWorkerCount();
+        static void* EnqueueTask(b2TaskCallback* task, int itemCount, int minRange, void* taskContext, void* userContext);
+        static void FinishTask(void* userTask, void* userContext);
+    private:
+        struct Task
+        {
+            b2TaskCallback* callback = nullptr;
+            void* context = nullptr;
+            std::atomic<int> pendingJobs = 0;
+        };
+
+        struct Job
+        {
+            Task* task;
+            int startIndex;
+            int endIndex;
+        };
+
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        void* enqueue(b2TaskCallback* callback, int itemCount, int minRange, void* context);
+        void finish(Task* task);
+        void workerLoop(int workerIndex);
+        bool popJob(int workerIndex, Job& job);
+        void runJob(const Job& job, int workerIndex);
+        Task* acquireTask();
+        void releaseTask(Task* task);
+
+        int workerCount = 1;
+        std::vector<std::thread> threads;
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+        std::atomic<int> queuedJobs = 0;
+        std::atomic<bool> running = true;
+        std::mutex wakeMutex;
+        std::condition_variable wakeCondition;
+        std::mutex taskMutex;
+        std::vector<std::unique_ptr<Task>> taskPool;
+        std::vector<Task*> freeTasks;
+        int nextQueue = 0;
+    };
+}
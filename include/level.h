@@ -0,0 +1,116 @@
+#pragma once
+#include "raylib.h"
+#include "box2d/box2d.h"
+#include "box2d/base.h"
+#include <cstdint>
+#include <vector>
+#include <optional>
+#include <utility>
+#include "car.h"
+#include "entity_store.h"
+#include "job_system.h"
+#include "level_data.h"
+#include "node_grid.h"
+#include "substep_controller.h"
+
+namespace scene
+{
+    // Weld between a node and one end of a beam
+    struct Joint {
+        EntityHandle node;
+        EntityHandle beam;
+        b2JointId id;
+    };
+
+    enum class LevelState {
+        PLAYING,
+        PASSED,
+        LOSE
+    };
+
+    inline b2Transform LerpTransform(b2Transform a, b2Transform b, float alpha)
+    {
+        return b2Transform { b2Lerp(a.p, b.p, alpha), b2NLerp(a.q, b.q, alpha) };
+    }
+
+    // Simulation side of a level: Box2D world, car, nodes, beams and the win/lose checks.
+    // Never touches the window, GPU or audio device, so it runs in headless builds too.
+    class Level
+    {
+    public:
+        Level() = default;
+        ~Level();
+        Level(const Level&) = delete;
+        Level& operator=(const Level&) = delete;
+
+        void SetJobSystem(core::JobSystem* jobs) { jobSystem = jobs; }
+        void Build(const LevelData& data);
+        void Destroy();
+        bool IsBuilt() const { return worldId.has_value(); }
+        int Update(float frameTime);
+        void Step(float timeStep, int subStepCount);
+        void SetAdaptiveSubSteps(bool enabled, const SubStepOptions& options = SubStepController::DefaultOptions());
+        void SetSubStepCount(int count) { currentSubSteps = count; }
+        int GetSubStepCount() const { return currentSubSteps; }
+        float MeasureJointError() const;
+        EntityHandle AddJoint(EntityHandle nodeA, EntityHandle nodeB);
+        bool AddJoint(int nodeA, int nodeB);
+        bool RemoveJoint(EntityHandle beam);
+        std::pair<EntityHandle, EntityHandle> BeamNodes(EntityHandle beam) const;
+        EntityHandle PickBeam(Vector2 point);
+        EntityHandle AddNode(Vector2 position);
+        EntityHandle PickNode(Vector2 point);
+        void MoveCar();
+        LevelState GetState() const { return state; }
+        float GetAlpha() const { return accumulator / fixedTimeStep; }
+        int GetStepCount() const { return stepCount; }
+        int GetAwakeBodyCount() const { return awakeBodyCount; }
+        uint64_t ComputeChecksum() const;
+        b2Transform GetInterpolatedTransform(const EntityStore& store, int index) const;
+
+        static constexpr float fixedTimeStep = 1.0f / 60.0f;
+        static constexpr int defaultSubStepCount = 4;
+        static constexpr int maxCatchUpSteps = 5;
+        static constexpr float nodePickMargin = 12.0f;
+        static constexpr float carWakeMargin = 64.0f;
+
+        Car& GetCar() { return m_car; }
+        const EntityStore& Nodes() const { return nodeEntities; }
+        const EntityStore& Grounds() const { return groundEntities; }
+        const EntityStore& JointBodies() const { return jointBodyEntities; }
+        const std::vector<Joint>& Joints() const { return jointEntities; }
+        Rectangle PassedArea() const { return passedArea; }
+        Rectangle LoseArea() const { return loseArea; }
+    private:
+        void createB2World();
+        void checkCarCollision();
+        void createGroundShape(b2BodyId groundId, Rectangle rect);
+        EntityHandle createNodeEntity(Rectangle rect);
+        void wakeBodiesNearCar();
+        void storePreviousTransforms();
+        void applyBodyMoveEvents();
+        void updateSubSteps();
+        void rebuildNodeGrid();
+
+        LevelState state = LevelState::PLAYING;
+        std::optional<b2WorldId> worldId;
+        EntityStore groundEntities;
+        EntityStore nodeEntities;
+        NodeGrid nodeGrid;
+        bool nodeGridDirty = true;
+        std::vector<Joint> jointEntities;
+        EntityStore jointBodyEntities;
+        Rectangle passedArea = { 0.0f, 0.0f, 0.0f, 0.0f };
+        Rectangle loseArea = { 0.0f, 0.0f, 0.0f, 0.0f };
+        Car m_car;
+        core::JobSystem* jobSystem = nullptr;
+        float accumulator = 0.0f;
+        int stepCount = 0;
+        int awakeBodyCount = 0;     // bodies that moved in the last step
+        int currentSubSteps = defaultSubStepCount;
+        bool adaptiveSubSteps = false;
+        SubStepController subStepController;
+        float lastStepMs = 0.0f;
+        bool stepMeasured = false;
+    };
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "raylib.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ldtk
+{
+    class Level;
+}
+
+namespace core
+{
+    class MappedFile;
+}
+
+namespace scene
+{
+    struct TileDraw
+    {
+        Rectangle source;
+        Vector2 position;
+    };
+
+    struct TileLayerData
+    {
+        std::string tileset;
+        std::vector<TileDraw> tiles;
+    };
+
+    // Everything needed to build and present one level, parsed out of the LDtk project.
+    // Pure CPU data: no window, GPU or Box2D world is required to create or hold it.
+    struct LevelData
+    {
+        std::string name;
+        Vector2 size = { 0.0f, 0.0f };
+        std::string background;
+        std::vector<TileLayerData> tileLayers;   // back to front
+        bool hasCar = false;
+        Vector2 carPosition = { 0.0f, 0.0f };
+        std::vector<Rectangle> statics;
+        std::vector<Rectangle> terrain;          // IntGrid collision cells merged into boxes
+        std::vector<Rectangle> nodes;
+        Rectangle passed = { 0.0f, 0.0f, 0.0f, 0.0f };
+        Rectangle lose = { 0.0f, 0.0f, 0.0f, 0.0f };
+    };
+
+    // Merges the solid cells of a row-major grid into as few axis-aligned boxes as a
+    // greedy scan finds: runs along a row, then grown downwards while the run repeats.
+    std::vector<Rectangle> MergeSolidCells(const std::vector<uint8_t>& solid, int columns, int rows, float cellSize, Vector2 offset = { 0.0f, 0.0f });
+
+    // All levels of the game. Loaded either from the LDtk project (parsed up front) or from
+    // the compiled levels.bin, which is mapped and decoded one level at a time on first use.
+    class LevelProject
+    {
+    public:
+        LevelProject();
+        ~LevelProject();
+        LevelProject(const LevelProject&) = delete;
+        LevelProject& operator=(const LevelProject&) = delete;
+
+        bool LoadFromLdtk(const std::string& path);
+        bool LoadFromBinary(const std::string& path);
+        // Compiled levels already in memory (e.g. an entry of the mapped resource pack),
+        // used in place: the memory must outlive the project
+        bool LoadFromMemory(const unsigned char* data, size_t size, const std::string& name);
+        bool SaveBinary(const std::string& path) const;
+        void Add(LevelData data);
+        int Count() const;
+        const LevelData& Get(int index) const;
+
+        static LevelData ParseLevel(const ldtk::Level& level);
+    private:
+        struct BinaryRecord
+        {
+            uint32_t offset;
+            uint32_t size;
+        };
+
+        bool decodeBinary(int index, LevelData& data) const;
+
+        mutable std::vector<std::unique_ptr<LevelData>> levels;
+        mutable std::mutex decodeMutex;
+        std::unique_ptr<core::MappedFile> binary;     // set when loaded from a file
+        const unsigned char* binaryData = nullptr;
+        std::vector<BinaryRecord> records;
+    };
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "raylib.h"
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "level.h"
+#include "level_data.h"
+
+namespace core
+{
+    class BackgroundWorker;
+    class JobSystem;
+}
+
+namespace scene
+{
+    struct DecodedImage
+    {
+        std::string path;
+        Image image;
+    };
+
+    // A level made ready off the main thread: data decoded, images decoded to CPU memory
+    // and the Box2D world built. Only the GPU upload is left to do.
+    struct PreparedLevel
+    {
+        int index = -1;
+        const LevelData* data = nullptr;
+        std::unique_ptr<Level> level;
+        std::vector<DecodedImage> images;
+    };
+
+    // Prepares one level on the background worker. The images listed in Start are decoded
+    // with LoadImage, so callers pass only the paths that are not already uploaded.
+    class LevelPreloader
+    {
+    public:
+        LevelPreloader() = default;
+        ~LevelPreloader();
+        LevelPreloader(const LevelPreloader&) = delete;
+        LevelPreloader& operator=(const LevelPreloader&) = delete;
+
+        void Start(const LevelProject& project, int index, std::vector<std::string> imagePaths, core::JobSystem* jobs, core::BackgroundWorker* worker);
+        void Cancel();
+        bool IsReady() const;
+        int GetIndex() const { return index; }
+        PreparedLevel Take();
+    private:
+        static PreparedLevel prepare(const LevelProject& project, int index, std::vector<std::string> imagePaths, core::JobSystem* jobs);
+
+        std::future<PreparedLevel> pending;
+        int index = -1;
+    };
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace core
+{
+    // Read-only view of a whole file. Memory mapped on desktop so only the pages that
+    // are touched get read; platforms without mmap (web) read the file into memory.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const std::string& path);
+        void Close();
+        bool IsOpen() const { return data != nullptr; }
+        const unsigned char* Data() const { return data; }
+        size_t Size() const { return size; }
+    private:
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+        bool mapped = false;
+        std::vector<unsigned char> buffer;
+#if defined(_WIN32)
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+    };
+}
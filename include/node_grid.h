@@ -0,0 +1,30 @@
+#pragma once
+#include "raylib.h"
+#include <cstdint>
+#include <vector>
+
+namespace scene
+{
+    // Uniform grid over a set of rectangles for point queries. Items are referred to by
+    // their index in the array given to Build; a query returns the lowest matching index,
+    // which is the same answer a front-to-back linear scan would give.
+    class NodeGrid
+    {
+    public:
+        void Build(const std::vector<Rectangle>& rects);
+        void Clear();
+        int Query(Vector2 point) const;
+        int GetItemCount() const { return static_cast<int>(rects.size()); }
+
+        static constexpr float cellSize = 32.0f;
+    private:
+        int cellIndex(int x, int y) const { return y*columns + x; }
+
+        std::vector<Rectangle> rects;
+        std::vector<uint32_t> cellStart;    // columns*rows + 1 offsets into cellItems
+        std::vector<uint32_t> cellItems;
+        Vector2 origin = { 0.0f, 0.0f };
+        int columns = 0;
+        int rows = 0;
+    };
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "raylib.h"
+#include "box2d/id.h"
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------
+// Frame profiler. Built only with the NEXTJAM_PROFILER CMake option; without it the
+// macros below expand to nothing and this header is never needed at runtime.
+//
+//   PROFILE_SCOPE("name")   time the rest of the enclosing block
+//   PROFILE_WORLD(worldId)  add Box2D's profile and counters for the last step
+//
+// Samples are summed per frame. Only the thread that calls BeginFrame is recorded,
+// so simulation code shared with worker threads can stay instrumented. When the
+// TraceRecorder is enabled every scope, on any thread, is also a trace event.
+//----------------------------------------------------------------------------------
+
+namespace core
+{
+    class Profiler
+    {
+    public:
+        static Profiler* getInstance();
+        static void cleanup();
+        static int RegisterSeries(const char* name, bool isTime = true);
+        // Where profiling output goes: relative paths resolve next to the executable,
+        // never in the working directory, which can be the resource folder that is packed
+        static std::string OutputPath(const std::string& path);
+
+        void BeginFrame(int level);
+        void EndFrame();
+        void AddSample(int series, double value);
+        void SetValue(int series, double value);
+        void RecordWorld(b2WorldId worldId);
+
+        void ToggleOverlay() { overlayVisible = !overlayVisible; overlayUsed |= overlayVisible; }
+        bool IsOverlayVisible() const { return overlayVisible; }
+        void DrawOverlay(int x, int y) const;
+        bool WriteCsv(const std::string& path) const;
+
+        static constexpr int windowFrames = 240;
+        static constexpr int historyFrames = 60 * 60 * 10;
+    private:
+        Profiler() = default;
+        ~Profiler() = default;
+
+        struct Series
+        {
+            std::vector<float> window;
+            int head = 0;
+            int count = 0;
+            double current = 0.0;
+        };
+
+        struct FrameRecord
+        {
+            int frame;
+            int level;
+            std::vector<float> values;
+        };
+
+        struct SeriesInfo
+        {
+            std::string name;
+            bool isTime;
+        };
+
+        static std::vector<SeriesInfo>& registry();
+        bool isRecording() const;
+
+        inline static Profiler* instance = nullptr;
+        std::vector<Series> series;
+        std::deque<FrameRecord> history;
+        std::chrono::steady_clock::time_point frameStart;
+        int frameIndex = 0;
+        int currentLevel = 0;
+        bool overlayVisible = false;
+        bool overlayUsed = false;       // profile.csv is only written once the overlay was opened
+    };
+
+    class ProfileScope
+    {
+    public:
+        ProfileScope(int series, const char* name) : series(series), name(name), start(std::chrono::steady_clock::now()) {}
+        ~ProfileScope();
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+    private:
+        int series;
+        const char* name;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+#if defined(NEXTJAM_PROFILER)
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) \
+    static const int PROFILE_CONCAT(profileSeries, __LINE__) = core::Profiler::RegisterSeries(name); \
+    core::ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(PROFILE_CONCAT(profileSeries, __LINE__), name)
+#define PROFILE_WORLD(worldId) core::Profiler::getInstance()->RecordWorld(worldId)
+#else
+#define PROFILE_SCOPE(name) do { } while (false)
+#define PROFILE_WORLD(worldId) do { } while (false)
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+#include "raylib.h"
+#include <string>
+#include <unordered_map>
+
+namespace core
+{
+    // Uploaded textures keyed by file path with reference counting. A texture is decoded
+    // and uploaded on the first Acquire and unloaded when the last holder releases it.
+    // Main thread only; background loaders hand over decoded Images instead.
+    class ResourceCache
+    {
+    public:
+        static ResourceCache* getInstance();
+        static void cleanup();
+
+        Texture2D AcquireTexture(const std::string& path);
+        Texture2D AcquireTexture(const std::string& path, Image image);
+        bool HasTexture(const std::string& path) const { return textures.count(path) > 0; }
+        void ReleaseTexture(const std::string& path);
+        int GetTextureCount() const { return static_cast<int>(textures.size()); }
+    private:
+        ResourceCache() = default;
+        ~ResourceCache();
+
+        struct TextureEntry
+        {
+            Texture2D texture;
+            int refCount;
+        };
+
+        inline static ResourceCache* instance = nullptr;
+        std::unordered_map<std::string, TextureEntry> textures;
+    };
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "raylib.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "mapped_file.h"
+
+namespace core
+{
+    // Bytes of one asset. Points straight into the mapped pack for stored entries; owns
+    // the buffer for deflated entries and loose files (freed with MemFree).
+    class AssetData
+    {
+    public:
+        AssetData() = default;
+        AssetData(const unsigned char* view, int viewSize) : data(view), size(viewSize) { }
+        static AssetData Adopt(unsigned char* buffer, int size);
+        ~AssetData();
+        AssetData(AssetData&& other) noexcept;
+        AssetData& operator=(AssetData&& other) noexcept;
+        AssetData(const AssetData&) = delete;
+        AssetData& operator=(const AssetData&) = delete;
+
+        explicit operator bool() const { return data != nullptr; }
+        const unsigned char* Data() const { return data; }
+        int Size() const { return size; }
+        bool IsMapped() const { return data && !owned; }
+    private:
+        const unsigned char* data = nullptr;
+        int size = 0;
+        unsigned char* owned = nullptr;
+    };
+
+    // One input file of a pack being written
+    struct PackSource
+    {
+        std::string name;                   // relative to the resource directory, '/' separated
+        std::vector<unsigned char> data;
+        bool compress = true;               // deflated when that saves at least an eighth
+        uint32_t storedSize = 0;            // filled in by Write
+    };
+
+    // resources.pak: every file of the resource directory in one indexed archive that is
+    // mapped once at startup. Assets are addressed by the path they would have as loose
+    // files (GetRoot() + "/name"), so loaders ask for paths either way and the ones the
+    // pack does not hold fall back to the file system.
+    class ResourcePack
+    {
+    public:
+        static ResourcePack* getInstance();
+        static void cleanup();
+
+        // Maps resources.pak from next to the executable, one directory up (multi-config
+        // build trees) or the working directory. NEXTJAM_LOOSE_RESOURCES=1 skips the pack.
+        bool OpenDefault();
+        bool Open(const std::string& path);
+        bool IsOpen() const { return file.IsOpen(); }
+        // The directory asset paths start with: where the pack stands in for resources/,
+        // or the loose resource directory when no pack is open
+        const std::string& GetRoot() const { return root; }
+        void SetRoot(const std::string& dir) { root = dir; }
+
+        bool Contains(const std::string& path) const;
+        // Thread safe once opened. Loose files are read when the pack has no such entry.
+        AssetData Read(const std::string& path) const;
+        Image LoadImage(const std::string& path) const;
+        Wave LoadWave(const std::string& path) const;
+
+        static bool Write(const std::string& path, std::vector<PackSource>& sources);
+    private:
+        ResourcePack() = default;
+        ~ResourcePack() = default;
+
+        struct Entry
+        {
+            uint32_t offset;
+            uint32_t storedSize;
+            uint32_t size;
+            uint32_t flags;
+        };
+
+        const Entry* find(const std::string& path) const;
+
+        inline static ResourcePack* instance = nullptr;
+        MappedFile file;
+        std::unordered_map<std::string, Entry> entries;
+        std::string root;
+    };
+}
@@ -1,92 +1,85 @@
 #pragma once
 #include "raylib.h"
-#include "box2d/box2d.h"
-#include "box2d/base.h"
-#include <LDtkLoader/Project.hpp>
-#include <LDtkLoader/World.hpp>
+#include <future>
+#include <memory>
+#include <string>
 #include <vector>
-#include <optional>
-#include <list>
-#include "car.h"
+#include "bridge_renderer.h"
+#include "edit_history.h"
+#include "input_recording.h"
+#include "level.h"
+#include "level_data.h"
+#include "level_preloader.h"
+#include "tilemap_renderer.h"
 
 
 namespace scene
 {
-    struct Entity
-    {
-        std::optional<b2BodyId> bodyId;
-        b2Vec2 extent;
-        Vector2 pos;
-    };
-
-    struct Joint {
-        Entity* nodeA;
-        Entity* nodeB;
-        b2JointId id;
-    };
-
-    enum class LevelState {
-        PLAYING,
-        PASSED,
-        LOSE
-    };
-
     class SceneManager
     {
     public:
         static SceneManager* getInstance();
         static void cleanup();
+        static std::unique_ptr<LevelProject> LoadLevelProject(const std::string& dir);
+        static std::vector<std::string> LevelTexturePaths(const LevelData& data, const std::string& dir);
+        void SetLevelProject(std::unique_ptr<LevelProject> project);
         void Load();
         void Update();
+        void PrepareDraw();
         void Draw();
         void Reset();
+        void Restart();
         Rectangle& ScreenInWorld();
         bool IsLevelClear();
         void NextLevel();
         bool IsLastLevel();
+        int GetCurrentLevel() const;
         void setLevel(int level);
         void MoveCar();
         void SetTutotrialPassed();
     private:
         SceneManager();
-        ~SceneManager() = default;
-        void createB2World();
+        ~SceneManager();
+        void prepareTilemap(const LevelData& data, const std::vector<DecodedImage>& images);
+        void updateCamera();
+        void preloadNextLevel();
+        void prepareSpareLevel(std::unique_ptr<Level> level = nullptr);
+        void recordInput(InputType type, int a = -1, int b = -1);
+        void handleEditKeys();
         void checkCollisions();
         void checkNodesCollision();
-        void checkCarCollision();
-        bool checkEntityCollision(Entity* entity, Vector2 point);
-        void DrawEntity(const Entity& entity, Color color);
-        void DrawJointBodies(const Entity& entity, Color color);
+        void onLevelStateChanged(LevelState state);
+        bool checkEntityCollision(EntityHandle node, Vector2 point);
+        void DrawEntity(const EntityStore& store, int index, Color color);
+        void drawBridge();
         void DrawJoint(const Joint& joint);
-        void AddJoint(Entity* entityA, Entity* entityB);
-        void addNode(Vector2 position);
         inline static SceneManager* instance = nullptr;
-        LevelState state = LevelState::PLAYING;
-        ldtk::Project ldtkProject;
-        const ldtk::World* ldtkWorld{};
-        const ldtk::Level* currentLdtkLevel{};
+        std::unique_ptr<LevelProject> levelProject;
+        std::unique_ptr<Level> activeLevel;
+        // Freshly built copy of the current level: restarting swaps it in
+        std::future<std::unique_ptr<Level>> spareLevel;
+        int spareLevelIndex = -1;
+        EditHistory editHistory;
+        LevelPreloader preloader;
+        BridgeRenderer bridgeRenderer;
         int currentLevel = 0;
         int maxLevels = 1;
-        Texture2D currentTilesetTexture;
-        Texture2D renderedLevelTexture;
+        std::vector<std::string> levelTextures;
+        TilemapRenderer tilemap;
+        int tilemapLevelIndex = -1;
+        Vector2 levelSize = { 0.0f, 0.0f };
         Rectangle screenInWorld;
         Camera2D worldCamera = { };
         float seconds = {};
-        std::optional<b2WorldId> worldId;
-        std::vector<Entity> groundEntities;
-        std::list<Entity> nodeEntities;
-        std::vector<Joint> jointEntities;
-        std::vector<Entity> jointBodyEntities;
-        Entity passedEntity;
-        Entity loseEntity;
-        Entity* focusNode = nullptr;
-        Entity* selectedNode = nullptr;
+        EntityHandle focusNode;
+        EntityHandle selectedNode;
         Vector2 mousePosition;
-        Car m_car;
         int tutorialStep = 0;
         std::vector<Texture2D> tutorials;
         std::vector<Vector2> tutorialPos;
         bool tutorialPassed = false;
+        InputRecording recording;
+        std::string recordingPath;
     };
 
 }
\ No newline at end of file
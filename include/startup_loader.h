@@ -0,0 +1,92 @@
+#pragma once
+#include "raylib.h"
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "level_data.h"
+#include "level_preloader.h"
+#include "resource_pack.h"
+
+namespace core
+{
+    // Load time of one startup asset: the part on a worker thread and the part left on
+    // the main thread (GPU upload, audio device binding, or everything for main steps)
+    struct StartupTiming
+    {
+        std::string name;
+        double workerMs = 0.0;
+        double mainMs = 0.0;
+    };
+
+    // Cold start in two stages. Start() runs the file reads, image/font/audio decoding and
+    // the level project parse on worker threads, before the window even exists; Finish()
+    // waits for each result in turn and keeps only uploads and device binding on the main
+    // thread. Textures the scene acquires later (tutorials, first level) are uploaded into
+    // the resource cache and held until ReleasePrimedTextures().
+    class StartupLoader
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        void Start(const std::string& dir);
+        void Finish();
+        std::unique_ptr<scene::LevelProject> TakeLevelProject() { return std::move(levelProject); }
+        void ReleasePrimedTextures();
+        void Report(double firstFrameMs) const;
+
+        // Times a main thread step for the report
+        template <typename Step>
+        void RunOnMain(const char* name, Step step)
+        {
+            auto start = Clock::now();
+            step();
+            timings.push_back(StartupTiming { name, 0.0, elapsedMs(start) });
+        }
+    private:
+        template <typename Result>
+        struct Timed
+        {
+            Result value;
+            double ms = 0.0;
+        };
+
+        template <typename Result>
+        struct Pending
+        {
+            std::string name;
+            std::future<Timed<Result>> result;
+        };
+
+        struct DecodedFont
+        {
+            Font font = { };
+            Image atlas = { };
+        };
+
+        struct DecodedProject
+        {
+            std::unique_ptr<scene::LevelProject> project;
+            std::vector<scene::DecodedImage> images;    // first level's background and tilesets
+        };
+
+        template <typename Result, typename Work>
+        static Pending<Result> launch(std::string name, Work work);
+        static DecodedFont decodeFont(const std::string& path, int fontSize, int glyphCount);
+        static double elapsedMs(Clock::time_point start);
+
+        std::string dir;
+        Pending<DecodedFont> font;
+        Pending<Image> carTexture;
+        Pending<Image> wheelTexture;
+        std::vector<Pending<scene::DecodedImage>> tutorialImages;
+        std::vector<Pending<Wave>> effects;
+        Pending<AssetData> engineLoop;
+        Pending<DecodedProject> project;
+        std::unique_ptr<scene::LevelProject> levelProject;
+        std::vector<std::string> primedTextures;
+        std::vector<StartupTiming> timings;
+        double finishMs = 0.0;
+    };
+}
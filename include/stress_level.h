@@ -0,0 +1,28 @@
+#pragma once
+#include "bridge_evaluator.h"
+#include "level_data.h"
+
+namespace scene
+{
+    struct StressLevelOptions
+    {
+        int nodeCount = 1000;        // rounded up to whole columns of `rows` nodes
+        int rows = 2;                // decks stacked below the one level with the cliffs
+        float spacing = 48.0f;       // between neighbouring nodes, also the beam length
+        unsigned int seed = 1;       // chasm floor bumps
+        bool tiles = true;           // tile layer over the cliffs and the floor, for draw cost
+    };
+
+    // A generated level together with a bridge that spans it
+    struct StressLevel
+    {
+        LevelData data;
+        BridgeDesign bridge;
+    };
+
+    // Two cliffs around a chasm as wide as the node columns, car on the left cliff, the
+    // goal on the right one and the lose zone along the bumpy chasm floor. Nodes are laid
+    // out row by row from the left cliff edge to the right one; the bridge joins every
+    // pair of neighbours in each row.
+    StressLevel GenerateStressLevel(const StressLevelOptions& options);
+}
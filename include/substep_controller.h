@@ -0,0 +1,35 @@
+#pragma once
+
+namespace scene
+{
+    struct SubStepOptions
+    {
+        int minSubSteps = 2;
+        int maxSubSteps = 8;
+        float stepBudgetMs = 4.0f;      // b2World_Step time a single fixed step may take
+        float raiseError = 2.0f;        // weld separation (px) that asks for more sub-steps
+        float lowerError = 0.5f;        // below this the bridge is calm enough for fewer
+        int calmUpdates = 30;           // consecutive calm updates before stepping down
+    };
+
+    // Picks the Box2D sub-step count from how far the welds are pulled apart and how
+    // long the last steps took: stiff bridges under the car get more sub-steps as long
+    // as they fit the budget, empty levels and sleeping bridges fall back to the minimum.
+    class SubStepController
+    {
+    public:
+        SubStepController() = default;
+        explicit SubStepController(const SubStepOptions& options) : options(options) {}
+
+        // Called once per frame before stepping; returns the sub-step count to use
+        int Update(int current, float jointError, float stepMs);
+        void Reset() { calm = 0; }
+        const SubStepOptions& GetOptions() const { return options; }
+
+        // NEXTJAM_STEP_BUDGET_MS overrides the step budget
+        static SubStepOptions DefaultOptions();
+    private:
+        SubStepOptions options;
+        int calm = 0;
+    };
+}
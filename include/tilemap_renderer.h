@@ -0,0 +1,56 @@
+#pragma once
+#include "raylib.h"
+#include <vector>
+#include "level_data.h"
+
+namespace scene
+{
+    // Draws a level's tile layers from fixed-size chunks. A chunk is baked into its own
+    // render texture the first time it becomes visible and released again after it has
+    // been off screen for a while, so GPU memory follows the view instead of the level
+    // size. Bake in Update, outside of any BeginTextureMode, then Draw inside the camera.
+    class TilemapRenderer
+    {
+    public:
+        TilemapRenderer() = default;
+        ~TilemapRenderer();
+        TilemapRenderer(const TilemapRenderer&) = delete;
+        TilemapRenderer& operator=(const TilemapRenderer&) = delete;
+
+        void Build(const LevelData& data, Texture2D background, const std::vector<Texture2D>& tilesets);
+        void Unload();
+        void Update(Rectangle view);
+        void Draw(Rectangle view) const;
+        int GetResidentChunkCount() const { return residentCount; }
+
+        static constexpr int chunkSize = 256;
+        static constexpr int evictAfterFrames = 180;
+    private:
+        struct ChunkTile
+        {
+            int layer;
+            TileDraw draw;
+        };
+
+        struct Chunk
+        {
+            Rectangle bounds;
+            std::vector<ChunkTile> tiles;
+            RenderTexture2D target = { };
+            bool resident = false;
+            int lastVisibleFrame = 0;
+        };
+
+        bool visibleRange(Rectangle view, int& x0, int& y0, int& x1, int& y1) const;
+        void bake(Chunk& chunk);
+        void evict(Chunk& chunk);
+
+        Texture2D background = { };
+        std::vector<Texture2D> tilesets;
+        std::vector<Chunk> chunks;
+        int columns = 0;
+        int rows = 0;
+        int frame = 0;
+        int residentCount = 0;
+    };
+}
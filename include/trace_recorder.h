@@ -0,0 +1,32 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace core
+{
+    // Chrome trace_event recorder fed by PROFILE_SCOPE. Every thread writes complete
+    // events into its own fixed-size ring without locks; Dump copies the recent ones
+    // into a JSON file that opens in Perfetto or about:tracing. Off unless enabled
+    // with --trace or NEXTJAM_TRACE; the frame budget comes from NEXTJAM_TRACE_BUDGET_MS.
+    class TraceRecorder
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static void Configure(int argc, char** argv);
+        static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+        static void SetThreadName(const char* name);
+        static void Record(const char* name, Clock::time_point start, Clock::time_point end);
+        static bool Dump(const std::string& path, double seconds);
+        static void OnFrameEnd(double frameMs);
+
+        static constexpr int eventsPerThread = 1 << 14;
+        static constexpr double dumpSeconds = 3.0;
+        static constexpr double minSecondsBetweenDumps = 5.0;
+        static constexpr int maxDumps = 20;
+    private:
+        inline static std::atomic<bool> enabled = false;
+    };
+}
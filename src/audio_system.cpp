@@ -0,0 +1,170 @@
+#include "audio_system.h"
+
+#include <chrono>
+#include "profiler.h"
+#include "trace_recorder.h"
+
+using namespace core;
+
+AudioSystem* AudioSystem::getInstance()
+{
+    if (!instance)
+    {
+        instance = new AudioSystem();
+    }
+    return instance;
+}
+
+void AudioSystem::cleanup()
+{
+    delete instance;
+    instance = nullptr;
+}
+
+AudioSystem::AudioSystem()
+{
+#if !defined(PLATFORM_WEB)
+    refillThread = std::thread(&AudioSystem::refillLoop, this);
+#endif
+}
+
+AudioSystem::~AudioSystem()
+{
+    running = false;
+    if (refillThread.joinable())
+    {
+        refillThread.join();
+    }
+    for (auto& stream : streams)
+    {
+        UnloadMusicStream(stream.music);
+    }
+    for (auto& effect : effects)
+    {
+        for (auto& alias : effect.aliases)
+        {
+            UnloadSoundAlias(alias);
+        }
+        UnloadSound(effect.sound);
+    }
+}
+
+EffectId AudioSystem::LoadEffect(const std::string& path, int voices)
+{
+    Wave wave = ResourcePack::getInstance()->LoadWave(path);
+    EffectId id = LoadEffect(wave, voices);
+    UnloadWave(wave);
+    return id;
+}
+
+// The wave stays owned by the caller, it can be decoded on any thread beforehand
+EffectId AudioSystem::LoadEffect(Wave wave, int voices)
+{
+    Effect effect;
+    effect.sound = LoadSoundFromWave(wave);
+    for (int i = 1; i < voices; i++)
+    {
+        effect.aliases.push_back(LoadSoundAlias(effect.sound));
+    }
+    effects.emplace_back(std::move(effect));
+    return static_cast<EffectId>(effects.size()) - 1;
+}
+
+// A free voice if there is one, otherwise the one started longest ago
+void AudioSystem::PlayEffect(EffectId id)
+{
+    if ((id < 0) || (id >= static_cast<int>(effects.size())))
+    {
+        return;
+    }
+    Effect& effect = effects[id];
+    int voiceCount = static_cast<int>(effect.aliases.size()) + 1;
+    auto voice = [&effect](int index) -> Sound& {
+        return (index == 0) ? effect.sound : effect.aliases[index - 1];
+    };
+    int chosen = effect.next;
+    for (int i = 0; i < voiceCount; i++)
+    {
+        int index = (effect.next + i) % voiceCount;
+        if (!IsSoundPlaying(voice(index)))
+        {
+            chosen = index;
+            break;
+        }
+    }
+    PlaySound(voice(chosen));
+    effect.next = (chosen + 1) % voiceCount;
+}
+
+StreamId AudioSystem::LoadStream(const std::string& path, bool inMemory)
+{
+    auto* pack = ResourcePack::getInstance();
+    if (inMemory || pack->Contains(path))
+    {
+        return LoadStream(GetFileExtension(path.c_str()), pack->Read(path));
+    }
+    Stream stream;
+    stream.music = LoadMusicStream(path.c_str());
+    std::lock_guard<std::mutex> lock(streamMutex);
+    streams.emplace_back(std::move(stream));
+    return static_cast<StreamId>(streams.size()) - 1;
+}
+
+StreamId AudioSystem::LoadStream(const std::string& fileType, AssetData file)
+{
+    Stream stream;
+    stream.music = file ? LoadMusicStreamFromMemory(fileType.c_str(), file.Data(), file.Size()) : Music { };
+    stream.file = std::move(file);
+    std::lock_guard<std::mutex> lock(streamMutex);
+    streams.emplace_back(std::move(stream));
+    return static_cast<StreamId>(streams.size()) - 1;
+}
+
+void AudioSystem::PlayStream(StreamId id)
+{
+    std::lock_guard<std::mutex> lock(streamMutex);
+    if ((id >= 0) && (id < static_cast<int>(streams.size())))
+    {
+        PlayMusicStream(streams[id].music);
+    }
+}
+
+void AudioSystem::StopStream(StreamId id)
+{
+    std::lock_guard<std::mutex> lock(streamMutex);
+    if ((id >= 0) && (id < static_cast<int>(streams.size())))
+    {
+        StopMusicStream(streams[id].music);
+    }
+}
+
+void AudioSystem::Update()
+{
+#if defined(PLATFORM_WEB)
+    refill();
+#endif
+}
+
+void AudioSystem::refill()
+{
+    PROFILE_SCOPE("Audio refill");
+    std::lock_guard<std::mutex> lock(streamMutex);
+    for (auto& stream : streams)
+    {
+        UpdateMusicStream(stream.music);
+    }
+}
+
+// Decoding a refill can take a few milliseconds (mp3, disk reads); here it only delays
+// this thread, the device keeps playing the buffered audio meanwhile
+void AudioSystem::refillLoop()
+{
+#if defined(NEXTJAM_PROFILER)
+    TraceRecorder::SetThreadName("audio stream");
+#endif
+    while (running)
+    {
+        refill();
+        std::this_thread::sleep_for(std::chrono::milliseconds(refillIntervalMs));
+    }
+}
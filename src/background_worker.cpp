@@ -0,0 +1,57 @@
+#include "background_worker.h"
+
+#include "trace_recorder.h"
+
+using namespace core;
+
+BackgroundWorker::BackgroundWorker()
+{
+#if !defined(PLATFORM_WEB)
+    thread = std::thread(&BackgroundWorker::run, this);
+#endif
+}
+
+// Work already queued still runs, so no future is left without a result
+BackgroundWorker::~BackgroundWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_one();
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+}
+
+void BackgroundWorker::push(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void BackgroundWorker::run()
+{
+#if defined(NEXTJAM_PROFILER)
+    TraceRecorder::SetThreadName("background loader");
+#endif
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return !jobs.empty() || !running; });
+            if (jobs.empty())
+            {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
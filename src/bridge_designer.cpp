@@ -0,0 +1,307 @@
+#include "bridge_designer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+using namespace scene;
+
+namespace
+{
+    // AddJoint shortens the beam by 8px at each end, anything shorter has no body
+    constexpr float minSpan = 16.0f;
+    constexpr float defaultSpanScale = 2.5f;
+    constexpr float failedCost = 1.0e6f;
+
+    float nodeDistance(const Rectangle& a, const Rectangle& b)
+    {
+        return std::hypot(b.x - a.x, b.y - a.y);
+    }
+}
+
+BridgeDesigner::BridgeDesigner(const LevelData& level, DesignerOptions options)
+    : level(level), options(options), evaluator(level, options.evaluator)
+{
+    stats.threadCount = evaluator.GetThreadCount();
+    findCandidates();
+}
+
+// Every node pair a beam could span. The span limit keeps the search space near linear
+// in the node count instead of quadratic.
+void BridgeDesigner::findCandidates()
+{
+    const auto& nodes = level.nodes;
+    float maxSpan = options.maxSpan;
+    if ((maxSpan <= 0.0f) && (nodes.size() > 1))
+    {
+        std::vector<float> nearest;
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            float best = FLT_MAX;
+            for (size_t j = 0; j < nodes.size(); j++)
+            {
+                float distance = nodeDistance(nodes[i], nodes[j]);
+                if ((i != j) && (distance > minSpan))
+                {
+                    best = std::min(best, distance);
+                }
+            }
+            if (best < FLT_MAX)
+            {
+                nearest.push_back(best);
+            }
+        }
+        if (!nearest.empty())
+        {
+            std::nth_element(nearest.begin(), nearest.begin() + nearest.size()/2, nearest.end());
+            maxSpan = nearest[nearest.size()/2]*defaultSpanScale;
+        }
+    }
+    for (int i = 0; i < static_cast<int>(nodes.size()); i++)
+    {
+        for (int j = i + 1; j < static_cast<int>(nodes.size()); j++)
+        {
+            float distance = nodeDistance(nodes[i], nodes[j]);
+            if ((distance > minSpan) && (distance <= maxSpan))
+            {
+                candidates.emplace_back(i, j);
+            }
+        }
+    }
+}
+
+// Each node joined to its nearest neighbour on the right: a plain deck, often already
+// passing, that gives the search a feasible starting point
+BridgeDesigner::Genome BridgeDesigner::seedGenome() const
+{
+    Genome genome(candidates.size(), 0);
+    std::vector<int> nearest(level.nodes.size(), -1);
+    std::vector<float> nearestDistance(level.nodes.size(), FLT_MAX);
+    for (size_t c = 0; c < candidates.size(); c++)
+    {
+        auto [a, b] = candidates[c];
+        if (level.nodes[a].x > level.nodes[b].x)
+        {
+            std::swap(a, b);
+        }
+        float distance = nodeDistance(level.nodes[a], level.nodes[b]);
+        if (distance < nearestDistance[a])
+        {
+            nearestDistance[a] = distance;
+            nearest[a] = static_cast<int>(c);
+        }
+    }
+    for (int c : nearest)
+    {
+        if (c >= 0)
+        {
+            genome[c] = 1;
+        }
+    }
+    return genome;
+}
+
+BridgeDesign BridgeDesigner::decode(const Genome& genome) const
+{
+    BridgeDesign design;
+    for (size_t c = 0; c < genome.size(); c++)
+    {
+        if (genome[c])
+        {
+            design.joints.push_back(candidates[c]);
+        }
+    }
+    return design;
+}
+
+float BridgeDesigner::cost(const BridgeResult& result, int beams) const
+{
+    if (!result.valid)
+    {
+        return FLT_MAX;
+    }
+    if (result.outcome != LevelState::PASSED)
+    {
+        return failedCost*(2.0f - result.progress) + beams;
+    }
+    return beams + options.stressWeight*result.peakJointError;
+}
+
+// Scores the genomes not seen before in one parallel batch; repeats (elites, converged
+// children) come from the cache
+std::vector<DesignCandidate> BridgeDesigner::evaluate(const std::vector<Genome>& genomes)
+{
+    std::vector<const Genome*> pending;
+    std::vector<BridgeDesign> designs;
+    for (auto& genome : genomes)
+    {
+        if (cache.count(genome) || std::any_of(pending.begin(), pending.end(), [&genome](const Genome* other) { return *other == genome; }))
+        {
+            stats.cacheHits++;
+            continue;
+        }
+        pending.push_back(&genome);
+        designs.push_back(decode(genome));
+    }
+    std::vector<BridgeResult> results = evaluator.EvaluateAll(designs);
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        int beams = static_cast<int>(designs[i].joints.size());
+        stats.evaluations++;
+        stats.steps += results[i].steps;
+        cache.emplace(*pending[i], DesignCandidate { std::move(designs[i]), results[i], cost(results[i], beams) });
+    }
+
+    std::vector<DesignCandidate> scored;
+    scored.reserve(genomes.size());
+    for (auto& genome : genomes)
+    {
+        scored.push_back(cache.at(genome));
+    }
+    return scored;
+}
+
+// Drops beams from a passing design while it keeps passing, trying every single
+// removal of a round in parallel and keeping the cheapest
+DesignCandidate BridgeDesigner::prune(Genome genome, DesignCandidate best)
+{
+    while (best.result.outcome == LevelState::PASSED)
+    {
+        std::vector<Genome> removals;
+        for (size_t c = 0; c < genome.size(); c++)
+        {
+            if (genome[c])
+            {
+                removals.push_back(genome);
+                removals.back()[c] = 0;
+            }
+        }
+        std::vector<DesignCandidate> scored = evaluate(removals);
+        int chosen = -1;
+        for (int i = 0; i < static_cast<int>(scored.size()); i++)
+        {
+            if ((scored[i].result.outcome == LevelState::PASSED) && (scored[i].cost < ((chosen < 0)? best.cost : scored[chosen].cost)))
+            {
+                chosen = i;
+            }
+        }
+        if (chosen < 0)
+        {
+            break;
+        }
+        genome = removals[chosen];
+        best = scored[chosen];
+    }
+    return best;
+}
+
+DesignCandidate BridgeDesigner::Run()
+{
+    auto start = std::chrono::steady_clock::now();
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    int populationSize = std::max(options.population, options.eliteCount + 1);
+    float mutationRate = (options.mutationRate > 0.0f)? options.mutationRate : 2.0f/std::max<size_t>(candidates.size(), 1);
+
+    // The seed deck, mutations of it, and random designs of about its density
+    Genome seed = seedGenome();
+    float density = candidates.empty()? 0.0f : float(std::count(seed.begin(), seed.end(), 1))/candidates.size();
+    std::vector<Genome> population = { seed };
+    while (static_cast<int>(population.size()) < populationSize)
+    {
+        bool fromSeed = population.size() < static_cast<size_t>(populationSize/2);
+        Genome genome = fromSeed? seed : Genome(candidates.size(), 0);
+        for (auto& bit : genome)
+        {
+            if (fromSeed? (unit(rng) < mutationRate) : (unit(rng) < density))
+            {
+                bit ^= 1;
+            }
+        }
+        population.push_back(std::move(genome));
+    }
+
+    std::vector<DesignCandidate> scored = evaluate(population);
+    auto bestOf = [&scored]() {
+        return static_cast<int>(std::min_element(scored.begin(), scored.end(), [](const DesignCandidate& a, const DesignCandidate& b) { return a.cost < b.cost; }) - scored.begin());
+    };
+    int bestIndex = bestOf();
+    Genome bestGenome = population[bestIndex];
+    DesignCandidate best = scored[bestIndex];
+    int stalled = 0;
+
+    std::uniform_int_distribution<int> pick(0, populationSize - 1);
+    auto tournament = [&]() {
+        int winner = pick(rng);
+        for (int i = 1; i < options.tournamentSize; i++)
+        {
+            int challenger = pick(rng);
+            if (scored[challenger].cost < scored[winner].cost)
+            {
+                winner = challenger;
+            }
+        }
+        return winner;
+    };
+
+    for (stats.generations = 0; (stats.generations < options.generations) && (stalled < options.stallGenerations); stats.generations++)
+    {
+        std::vector<int> order(populationSize);
+        for (int i = 0; i < populationSize; i++)
+        {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&scored](int a, int b) { return scored[a].cost < scored[b].cost; });
+
+        std::vector<Genome> next;
+        next.reserve(populationSize);
+        for (int i = 0; i < std::min(options.eliteCount, populationSize); i++)
+        {
+            next.push_back(population[order[i]]);
+        }
+        while (static_cast<int>(next.size()) < populationSize)
+        {
+            const Genome& parentA = population[tournament()];
+            const Genome& parentB = population[tournament()];
+            Genome child = parentA;
+            if (unit(rng) < options.crossoverRate)
+            {
+                for (size_t c = 0; c < child.size(); c++)
+                {
+                    if (unit(rng) < 0.5f)
+                    {
+                        child[c] = parentB[c];
+                    }
+                }
+            }
+            for (auto& bit : child)
+            {
+                if (unit(rng) < mutationRate)
+                {
+                    bit ^= 1;
+                }
+            }
+            next.push_back(std::move(child));
+        }
+        population = std::move(next);
+        scored = evaluate(population);
+
+        bestIndex = bestOf();
+        if (scored[bestIndex].cost < best.cost)
+        {
+            best = scored[bestIndex];
+            bestGenome = population[bestIndex];
+            stalled = 0;
+        }
+        else
+        {
+            stalled++;
+        }
+    }
+
+    best = prune(bestGenome, best);
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return best;
+}
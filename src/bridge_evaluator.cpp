@@ -0,0 +1,107 @@
+#include "bridge_evaluator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace scene;
+
+BridgeEvaluator::BridgeEvaluator(const LevelData& level, EvaluatorOptions options)
+    : level(level), options(options)
+{
+}
+
+int BridgeEvaluator::GetThreadCount() const
+{
+    if (options.threadCount > 0)
+    {
+        return options.threadCount;
+    }
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+BridgeResult BridgeEvaluator::Evaluate(const BridgeDesign& design) const
+{
+    Level simulation;
+    return run(simulation, design);
+}
+
+std::vector<BridgeResult> BridgeEvaluator::EvaluateAll(const std::vector<BridgeDesign>& designs) const
+{
+    std::vector<BridgeResult> results(designs.size());
+    std::atomic<size_t> next = 0;
+    // Each worker builds its own world; Level serialises the world create and destroy
+    auto worker = [&]() {
+        Level simulation;
+        for (size_t i = next++; i < designs.size(); i = next++)
+        {
+            results[i] = run(simulation, designs[i]);
+        }
+    };
+
+    int threadCount = std::min(GetThreadCount(), static_cast<int>(designs.size()));
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    return results;
+}
+
+BridgeResult BridgeEvaluator::run(Level& simulation, const BridgeDesign& design) const
+{
+    BridgeResult result;
+    simulation.Build(level);
+    for (auto& joint : design.joints)
+    {
+        if (!simulation.AddJoint(joint.first, joint.second))
+        {
+            return result;
+        }
+    }
+    result.valid = true;
+
+    int maxSteps = static_cast<int>(options.timeout / Level::fixedTimeStep);
+    int stallSteps = (options.stallTimeout > 0.0f)? static_cast<int>(options.stallTimeout / Level::fixedTimeStep) : maxSteps;
+    int lastProgressStep = 0;
+    float startX = level.carPosition.x;
+    float goalX = level.passed.x + level.passed.width/2.0f;
+    float furthest = startX;
+    simulation.MoveCar();
+    while ((result.steps < maxSteps) && (simulation.GetState() == LevelState::PLAYING))
+    {
+        simulation.Step(Level::fixedTimeStep, Level::defaultSubStepCount);
+        result.steps++;
+        if (options.measureJointError)
+        {
+            result.peakJointError = std::max(result.peakJointError, simulation.MeasureJointError());
+        }
+        // Progress counts in whole pixels so a car rocking in place reads as stalled
+        float carX = simulation.GetCar().GetPosition().x;
+        if (carX >= furthest + 1.0f)
+        {
+            furthest = carX;
+            lastProgressStep = result.steps;
+        }
+        else if (result.steps - lastProgressStep > stallSteps)
+        {
+            break;
+        }
+    }
+    if (goalX > startX)
+    {
+        result.progress = std::clamp((furthest - startX)/(goalX - startX), 0.0f, 1.0f);
+    }
+    result.outcome = simulation.GetState();
+    if (result.outcome == LevelState::PASSED)
+    {
+        result.progress = 1.0f;
+    }
+    result.timeToGoal = result.steps*Level::fixedTimeStep;
+    return result;
+}
@@ -0,0 +1,146 @@
+#include "bridge_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "raymath.h"
+#include "rlgl.h"
+
+using namespace scene;
+
+namespace
+{
+    constexpr int initialCapacity = 6 * 1024;
+    constexpr int dotSegments = 8;
+    // Attribute buffers filled by UploadMesh: 0 positions, 1 texcoords, 3 colours
+    constexpr int positionBuffer = 0;
+    constexpr int colorBuffer = 3;
+}
+
+BridgeRenderer::~BridgeRenderer()
+{
+    if (capacity > 0)
+    {
+        UnloadMesh(mesh);
+    }
+    if (materialLoaded)
+    {
+        UnloadMaterial(material);
+    }
+}
+
+void BridgeRenderer::Begin()
+{
+    vertexCount = 0;
+}
+
+// CPU arrays are kept at capacity; the GPU copy is recreated only when they grow
+void BridgeRenderer::reserve(int count)
+{
+    if (vertexCount + count <= capacity)
+    {
+        return;
+    }
+    int newCapacity = std::max({ initialCapacity, capacity * 2, vertexCount + count });
+    auto vertices = static_cast<float*>(MemAlloc(newCapacity * 3 * sizeof(float)));
+    auto colors = static_cast<unsigned char*>(MemAlloc(newCapacity * 4 * sizeof(unsigned char)));
+    if (capacity > 0)
+    {
+        std::memcpy(vertices, mesh.vertices, vertexCount * 3 * sizeof(float));
+        std::memcpy(colors, mesh.colors, vertexCount * 4 * sizeof(unsigned char));
+        UnloadMesh(mesh);
+    }
+    mesh = { };
+    mesh.vertices = vertices;
+    mesh.colors = colors;
+    mesh.texcoords = static_cast<float*>(MemAlloc(newCapacity * 2 * sizeof(float)));
+    mesh.vertexCount = newCapacity;
+    mesh.triangleCount = newCapacity / 3;
+    UploadMesh(&mesh, true);
+    capacity = newCapacity;
+}
+
+void BridgeRenderer::addVertex(float x, float y, Color color)
+{
+    float* position = mesh.vertices + vertexCount * 3;
+    position[0] = x;
+    position[1] = y;
+    position[2] = 0.0f;
+    unsigned char* rgba = mesh.colors + vertexCount * 4;
+    rgba[0] = color.r;
+    rgba[1] = color.g;
+    rgba[2] = color.b;
+    rgba[3] = color.a;
+    vertexCount++;
+}
+
+// a-b-c-d in the order raylib emits quads: top left, bottom left, bottom right, top right
+void BridgeRenderer::addQuad(Vector2 a, Vector2 b, Vector2 c, Vector2 d, Color color)
+{
+    reserve(6);
+    addVertex(a.x, a.y, color);
+    addVertex(b.x, b.y, color);
+    addVertex(c.x, c.y, color);
+    addVertex(a.x, a.y, color);
+    addVertex(c.x, c.y, color);
+    addVertex(d.x, d.y, color);
+}
+
+void BridgeRenderer::AddBox(b2Transform transform, b2Vec2 extent, Color color)
+{
+    b2Vec2 half = { extent.x / 2.0f, extent.y / 2.0f };
+    b2Vec2 topLeft = b2TransformPoint(transform, { -half.x, -half.y });
+    b2Vec2 bottomLeft = b2TransformPoint(transform, { -half.x, half.y });
+    b2Vec2 bottomRight = b2TransformPoint(transform, { half.x, half.y });
+    b2Vec2 topRight = b2TransformPoint(transform, { half.x, -half.y });
+    addQuad({ topLeft.x, topLeft.y }, { bottomLeft.x, bottomLeft.y }, { bottomRight.x, bottomRight.y }, { topRight.x, topRight.y }, color);
+}
+
+void BridgeRenderer::AddRectangleLines(Rectangle rect, Color color)
+{
+    float left = std::floor(rect.x);
+    float top = std::floor(rect.y);
+    float right = left + std::floor(rect.width);
+    float bottom = top + std::floor(rect.height);
+    addQuad({ left, top }, { left, top + 1.0f }, { right, top + 1.0f }, { right, top }, color);
+    addQuad({ left, bottom - 1.0f }, { left, bottom }, { right, bottom }, { right, bottom - 1.0f }, color);
+    addQuad({ left, top + 1.0f }, { left, bottom - 1.0f }, { left + 1.0f, bottom - 1.0f }, { left + 1.0f, top + 1.0f }, color);
+    addQuad({ right - 1.0f, top + 1.0f }, { right - 1.0f, bottom - 1.0f }, { right, bottom - 1.0f }, { right, top + 1.0f }, color);
+}
+
+void BridgeRenderer::AddDot(Vector2 center, float radius, Color color)
+{
+    reserve(dotSegments * 3);
+    float step = 2.0f * PI / dotSegments;
+    for (int i = 0; i < dotSegments; i++)
+    {
+        addVertex(center.x, center.y, color);
+        addVertex(center.x + std::cos(step * i) * radius, center.y + std::sin(step * i) * radius, color);
+        addVertex(center.x + std::cos(step * (i + 1)) * radius, center.y + std::sin(step * (i + 1)) * radius, color);
+    }
+}
+
+void BridgeRenderer::Draw()
+{
+    if (vertexCount == 0)
+    {
+        return;
+    }
+    if (!materialLoaded)
+    {
+        material = LoadMaterialDefault();
+        materialLoaded = true;
+    }
+    UpdateMeshBuffer(mesh, positionBuffer, mesh.vertices, vertexCount * 3 * sizeof(float), 0);
+    UpdateMeshBuffer(mesh, colorBuffer, mesh.colors, vertexCount * 4 * sizeof(unsigned char), 0);
+
+    // Flush what raylib has batched so far to keep the draw order, then submit the
+    // whole bridge; winding depends on the transform, so culling is off for the call
+    rlDrawRenderBatchActive();
+    rlDisableBackfaceCulling();
+    Mesh submitted = mesh;
+    submitted.vertexCount = vertexCount;
+    submitted.triangleCount = vertexCount / 3;
+    DrawMesh(submitted, material, MatrixIdentity());
+    rlEnableBackfaceCulling();
+}
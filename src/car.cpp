@@ -17,6 +17,9 @@ Car::Car()
 	m_rearAxleId = {};
 	m_frontAxleId = {};
 	m_isSpawned = false;
+	m_previousChassis = b2Transform_identity;
+	m_previousRearWheel = b2Transform_identity;
+	m_previousFrontWheel = b2Transform_identity;
 }
 
 void Car::Spawn( b2WorldId worldId, b2Vec2 position, float scale, float hertz, float dampingRatio, float torque)
@@ -91,6 +94,7 @@ void Car::Spawn( b2WorldId worldId, b2Vec2 position, float scale, float hertz, f
 	jointDef.enableLimit = true;
 	m_frontAxleId = b2CreateWheelJoint( worldId, &jointDef );
 	m_isSpawned = true;
+	StorePreviousTransforms();
 }
 
 void Car::Despawn()
@@ -111,30 +115,45 @@ void Car::Despawn()
 	position = {};
 }
 
-void Car::Draw()
+void Car::StorePreviousTransforms()
 {
 	if (!m_isSpawned) {
 		return;
 	}
-	position = b2Body_GetWorldPoint(m_chassisId, b2Vec2{ -boxExtent.x / 2.0f, -boxExtent.y / 2.0f + 4.0f });
-	b2Rot bodyRotation = b2Body_GetRotation(m_chassisId);
-	float bodyDeg = RAD2DEG * b2Rot_GetAngle(bodyRotation);
+	m_previousChassis = b2Body_GetTransform(m_chassisId);
+	m_previousRearWheel = b2Body_GetTransform(m_rearWheelId);
+	m_previousFrontWheel = b2Body_GetTransform(m_frontWheelId);
+}
+
+static b2Transform InterpolateBody(b2BodyId id, b2Transform previous, float alpha)
+{
+	b2Transform current = b2Body_GetTransform(id);
+	return { b2Lerp(previous.p, current.p, alpha), b2NLerp(previous.q, current.q, alpha) };
+}
+
+void Car::Draw(float alpha)
+{
+	if (!m_isSpawned) {
+		return;
+	}
+	b2Transform chassis = InterpolateBody(m_chassisId, m_previousChassis, alpha);
+	b2Vec2 drawPosition = b2TransformPoint(chassis, b2Vec2{ -boxExtent.x / 2.0f, -boxExtent.y / 2.0f + 4.0f });
+	float bodyDeg = RAD2DEG * b2Rot_GetAngle(chassis.q);
 
-	auto drawCircle = [this](b2BodyId id, Color color) {
-		b2Vec2 frontWheelVec = b2Body_GetWorldPoint(id, b2Vec2{  });
-		b2Rot fronWheelRotation = b2Body_GetRotation(id);
-		float fronWheelDeg = RAD2DEG * b2Rot_GetAngle(fronWheelRotation);
+	auto drawCircle = [alpha](b2BodyId id, b2Transform previous, Color color) {
+		b2Transform wheel = InterpolateBody(id, previous, alpha);
+		float fronWheelDeg = RAD2DEG * b2Rot_GetAngle(wheel.q);
 
 		Rectangle source = { 0.0f, 0.0f, (float)Resources::wheel.width, (float)Resources::wheel.height };
-		Rectangle dest = { frontWheelVec.x, frontWheelVec.y,
+		Rectangle dest = { wheel.p.x, wheel.p.y,
 			(float)Resources::wheel.width, (float)Resources::wheel.height };
 		Vector2 origin = { (float)Resources::wheel.width / 2.0f, (float)Resources::wheel.height / 2.0f };
 
 		DrawTexturePro(Resources::wheel, source, dest, origin, fronWheelDeg, WHITE);
 	};
-	drawCircle(m_frontWheelId, RED);
-	drawCircle(m_rearWheelId, BROWN);
-	DrawTextureEx(Resources::car, Vector2{ position.x, position.y }, bodyDeg, 1.0f, WHITE);
+	drawCircle(m_frontWheelId, m_previousFrontWheel, RED);
+	drawCircle(m_rearWheelId, m_previousRearWheel, BROWN);
+	DrawTextureEx(Resources::car, Vector2{ drawPosition.x, drawPosition.y }, bodyDeg, 1.0f, WHITE);
 }
 
 void Car::SetSpeed( float speed )
@@ -164,5 +183,8 @@ void Car::SetDampingRadio( float dampingRatio )
 
 Vector2 Car::GetPosition()
 {
+	if (m_isSpawned) {
+		position = b2Body_GetWorldPoint(m_chassisId, b2Vec2{ -boxExtent.x / 2.0f, -boxExtent.y / 2.0f + 4.0f });
+	}
 	return { position.x, position.y };
 }
@@ -5,7 +5,14 @@
 #include "raymath.h"
 #include "raygui.h"
 #include "resource.h"
+#include "audio_system.h"
+#include "background_worker.h"
+#include "job_system.h"
+#include "profiler.h"
+#include "resource_cache.h"
+#include "resource_pack.h"
 #include "scene_manager.h"
+#include "startup_loader.h"
 
 using namespace core;
 
@@ -20,32 +27,63 @@ Core* Core::getInstance()
 
 void Core::cleanup()
 {
-    
+    scene::SceneManager::cleanup();
+    core::ResourceCache::cleanup();
+    AudioSystem::cleanup();
+    ResourcePack::cleanup();
+#if defined(NEXTJAM_PROFILER)
+    Profiler::cleanup();
+#endif
     CloseAudioDevice();
     delete instance;
 }
 
 void Core::Init()
 {
-    SetConfigFlags(FLAG_VSYNC_HINT | FLAG_WINDOW_RESIZABLE);
-    InitWindow(screenWidth, screenHeight, "Next Bridge");
-    InitAudioDevice();
-    SearchAndSetResourceDir("resources");
-    std::string dir = GetWorkingDirectory();
-    GuiLoadStyle((dir + "/style.rgs").c_str());
-    Resources::LoadFonts();
-    Resources::LoadTextures();
-    Resources::LoadMusic();
+    startupBegin = StartupLoader::Clock::now();
+    // One mapped resources.pak when the build made one, the loose resources/ otherwise
+    auto* pack = ResourcePack::getInstance();
+    if (!pack->OpenDefault())
+    {
+        SearchAndSetResourceDir("resources");
+        pack->SetRoot(GetWorkingDirectory());
+    }
+    std::string dir = pack->GetRoot();
+    // Decoding starts before the window: the window, audio device and GL context take
+    // a while to come up and the workers fill that time
+    startup = std::make_unique<StartupLoader>();
+    startup->Start(dir);
+    startup->RunOnMain("window", []() {
+        SetConfigFlags(FLAG_VSYNC_HINT | FLAG_WINDOW_RESIZABLE);
+        InitWindow(screenWidth, screenHeight, "Next Bridge");
+    });
+    startup->RunOnMain("audio device", []() { InitAudioDevice(); });
+    startup->RunOnMain("style.rgs", [pack, &dir]() {
+        AssetData style = pack->Read(dir + "/style.rgs");
+        if (style)
+        {
+            GuiLoadStyleFromMemory(style.Data(), style.Size());
+        }
+    });
     //HideCursor();
     SetExitKey(KEY_NULL);
     SetTargetFPS(FIXED_FRAME_RATE);
+    startup->RunOnMain("job system", [this]() {
+        jobSystem = std::make_unique<JobSystem>(JobSystem::DefaultWorkerCount());
+        backgroundWorker = std::make_unique<BackgroundWorker>();
+    });
     target = LoadRenderTexture(gameScreenWidth, gameScreenHeight);
     //SetTextureFilter(target.texture, TEXTURE_FILTER_POINT);
-    scene::SceneManager::getInstance()->Load();
-    PlayMusicStream(Resources::music);
+    startup->Finish();
+    startup->RunOnMain("scene", [this]() {
+        auto* sceneManager = scene::SceneManager::getInstance();
+        sceneManager->SetLevelProject(startup->TakeLevelProject());
+        sceneManager->Load();
+    });
+    startup->ReleasePrimedTextures();
+    AudioSystem::getInstance()->PlayStream(Resources::music);
 }
 
-
 void Core::CenterWindow()
 {
     int monitor = GetCurrentMonitor();
@@ -121,7 +159,17 @@ Vector2 DrawCenteredText(const char* text, float textSize = 20, float yOffset =
 
 void Core::Update()
 {
-    UpdateMusicStream(Resources::music);
+#if defined(NEXTJAM_PROFILER)
+    Profiler::getInstance()->BeginFrame(scene::SceneManager::getInstance()->GetCurrentLevel());
+    if (IsKeyPressed(KEY_F3))
+    {
+        Profiler::getInstance()->ToggleOverlay();
+    }
+#endif
+    {
+        PROFILE_SCOPE("Audio");
+        AudioSystem::getInstance()->Update();
+    }
     if (isTouch())
     {
         lastGesture = currentGesture;
@@ -165,17 +213,17 @@ void Core::Update()
     {
         if (AcceptPressed())
         {
-            PlaySound(Resources::effect3);
+            AudioSystem::getInstance()->PlayEffect(Resources::effect3);
             tutorial = true;
             gameState = GameState::Playing;
-            scene::SceneManager::getInstance()->Load();
+            scene::SceneManager::getInstance()->Restart();
         }
     }
     if (gameState == GameState::Paused)
     {
         if (AcceptPressed())
         {
-            PlaySound(Resources::effect3);
+            AudioSystem::getInstance()->PlayEffect(Resources::effect3);
             gameState = GameState::Playing;
         }
     }
@@ -183,9 +231,8 @@ void Core::Update()
     {
         if (AcceptPressed())
         {
-            PlaySound(Resources::effect3);
-            scene::SceneManager::getInstance()->Reset();
-            scene::SceneManager::getInstance()->Load();
+            AudioSystem::getInstance()->PlayEffect(Resources::effect3);
+            scene::SceneManager::getInstance()->Restart();
             gameState = GameState::Playing;
         }
     }
@@ -209,7 +256,7 @@ void Core::Update()
     if (gameState == GameState::ChangingLevel)
     {
         if (AcceptPressed()) {
-            PlaySound(Resources::effect3);
+            AudioSystem::getInstance()->PlayEffect(Resources::effect3);
             if (scene::SceneManager::getInstance()->IsLastLevel()) {
                 gameState = GameState::Paused;
                 scene::SceneManager::getInstance()->setLevel(-1);
@@ -222,6 +269,7 @@ void Core::Update()
         }
     }
     float scale = MIN((float)GetScreenWidth() / gameScreenWidth, (float)GetScreenHeight() / gameScreenHeight);
+    scene::SceneManager::getInstance()->PrepareDraw();
     BeginTextureMode(target);
         ClearBackground(BLACK);
         scene::SceneManager::getInstance()->Draw();
@@ -253,7 +301,18 @@ void Core::Update()
         {
             DrawLoseMenu();
         }
+#if defined(NEXTJAM_PROFILER)
+        Profiler::getInstance()->DrawOverlay(10, 70);
+#endif
     EndDrawing();
+#if defined(NEXTJAM_PROFILER)
+    Profiler::getInstance()->EndFrame();
+#endif
+    if (startup)
+    {
+        startup->Report(std::chrono::duration<double, std::milli>(StartupLoader::Clock::now() - startupBegin).count());
+        startup.reset();
+    }
 }
 
 void Core::DrawMenu()
@@ -277,15 +336,14 @@ void Core::DrawGUI()
     }
     if (GuiButton({ Rectangle { 10.0f, 10.0f, 150.0f, 50.0f } }, GuiIconText(132, "PAUSE"))) {
         gameState = GameState::Paused;
-        PlaySound(Resources::effect2);
+        AudioSystem::getInstance()->PlayEffect(Resources::effect2);
     }
     if (GuiButton({ Rectangle { GetScreenWidth() - 310.0f, 10.0f, 150.0f, 50.0f } }, GuiIconText(77, "RESTART"))) {
-        PlaySound(Resources::effect2);
-        scene::SceneManager::getInstance()->Reset();
-        scene::SceneManager::getInstance()->Load();
+        AudioSystem::getInstance()->PlayEffect(Resources::effect2);
+        scene::SceneManager::getInstance()->Restart();
     }
     if (GuiButton({ Rectangle { GetScreenWidth() - 160.0f, 10.0f, 150.0f, 50.0f }}, GuiIconText(131, "PLAY"))) {
-        PlaySound(Resources::effect);
+        AudioSystem::getInstance()->PlayEffect(Resources::effect);
         scene::SceneManager::getInstance()->MoveCar();
         scene::SceneManager::getInstance()->SetTutotrialPassed();
     }
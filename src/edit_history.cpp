@@ -0,0 +1,140 @@
+#include "edit_history.h"
+
+using namespace scene;
+
+namespace
+{
+    constexpr uint32_t noBeamId = UINT32_MAX;
+}
+
+EntityHandle EditHistory::AddJoint(Level& level, EntityHandle nodeA, EntityHandle nodeB)
+{
+    int indexA = level.Nodes().Find(nodeA);
+    int indexB = level.Nodes().Find(nodeB);
+    if ((indexA < 0) || (indexB < 0))
+    {
+        return { };
+    }
+    Edit edit = { static_cast<uint32_t>(indexA), static_cast<uint32_t>(indexB), static_cast<uint32_t>(beams.size()), 0 };
+    beams.emplace_back();
+    if (!place(level, edit))
+    {
+        beams.pop_back();
+        return { };
+    }
+    push(edit);
+    return beams[edit.beam];
+}
+
+bool EditHistory::RemoveJoint(Level& level, EntityHandle beam)
+{
+    auto [nodeA, nodeB] = level.BeamNodes(beam);
+    int indexA = level.Nodes().Find(nodeA);
+    int indexB = level.Nodes().Find(nodeB);
+    if ((indexA < 0) || (indexB < 0))
+    {
+        return false;
+    }
+    Edit edit = { static_cast<uint32_t>(indexA), static_cast<uint32_t>(indexB), beamId(beam), 1 };
+    if (!remove(level, edit))
+    {
+        return false;
+    }
+    push(edit);
+    return true;
+}
+
+bool EditHistory::Undo(Level& level)
+{
+    if (!CanUndo())
+    {
+        return false;
+    }
+    const Edit& edit = edits[cursor - 1];
+    if (!(edit.removed? place(level, edit) : remove(level, edit)))
+    {
+        return false;
+    }
+    cursor--;
+    return true;
+}
+
+bool EditHistory::Redo(Level& level)
+{
+    if (!CanRedo())
+    {
+        return false;
+    }
+    const Edit& edit = edits[cursor];
+    if (!(edit.removed? remove(level, edit) : place(level, edit)))
+    {
+        return false;
+    }
+    cursor++;
+    return true;
+}
+
+void EditHistory::Clear()
+{
+    edits.clear();
+    cursor = 0;
+    beams.clear();
+    beamIdBySlot.clear();
+}
+
+size_t EditHistory::GetMemoryUsage() const
+{
+    return edits.capacity()*sizeof(Edit) + beams.capacity()*sizeof(EntityHandle) + beamIdBySlot.capacity()*sizeof(uint32_t);
+}
+
+// Beams placed outside the history (none in the game) get an id the first time one is named
+uint32_t EditHistory::beamId(EntityHandle beam)
+{
+    if ((beam.index < beamIdBySlot.size()) && (beamIdBySlot[beam.index] != noBeamId) && (beams[beamIdBySlot[beam.index]] == beam))
+    {
+        return beamIdBySlot[beam.index];
+    }
+    uint32_t id = static_cast<uint32_t>(beams.size());
+    beams.push_back(beam);
+    if (beam.index >= beamIdBySlot.size())
+    {
+        beamIdBySlot.resize(beam.index + 1, noBeamId);
+    }
+    beamIdBySlot[beam.index] = id;
+    return id;
+}
+
+bool EditHistory::place(Level& level, const Edit& edit)
+{
+    const EntityStore& nodes = level.Nodes();
+    if ((edit.nodeA >= static_cast<uint32_t>(nodes.Size())) || (edit.nodeB >= static_cast<uint32_t>(nodes.Size())))
+    {
+        return false;
+    }
+    EntityHandle beam = level.AddJoint(nodes.HandleAt(edit.nodeA), nodes.HandleAt(edit.nodeB));
+    if (!beam.IsValid())
+    {
+        return false;
+    }
+    beams[edit.beam] = beam;
+    if (beam.index >= beamIdBySlot.size())
+    {
+        beamIdBySlot.resize(beam.index + 1, noBeamId);
+    }
+    beamIdBySlot[beam.index] = edit.beam;
+    return true;
+}
+
+bool EditHistory::remove(Level& level, const Edit& edit)
+{
+    return level.RemoveJoint(beams[edit.beam]);
+}
+
+// A new edit drops the undone ones after the cursor. Their beam ids stay allocated
+// (8 bytes each) until the next Clear, which keeps every id a plain index.
+void EditHistory::push(Edit edit)
+{
+    edits.resize(cursor);
+    edits.push_back(edit);
+    cursor++;
+}
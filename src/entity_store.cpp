@@ -0,0 +1,96 @@
+#include "entity_store.h"
+
+using namespace scene;
+
+EntityHandle EntityStore::Create(Vector2 position, b2Vec2 extent, b2BodyId bodyId)
+{
+    uint32_t slot;
+    if (freeSlots.empty())
+    {
+        slot = static_cast<uint32_t>(slotDense.size());
+        slotDense.push_back(0);
+        slotGeneration.push_back(1);
+    }
+    else
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    EntityHandle handle { slot, slotGeneration[slot] };
+    slotDense[slot] = static_cast<uint32_t>(positions.size());
+    positions.push_back(position);
+    extents.push_back(extent);
+    bodyIds.push_back(bodyId);
+    transforms.push_back(B2_IS_NULL(bodyId) ? b2Transform_identity : b2Body_GetTransform(bodyId));
+    previousTransforms.push_back(transforms.back());
+    owners.push_back(handle);
+    return handle;
+}
+
+bool EntityStore::Destroy(EntityHandle handle)
+{
+    int index = Find(handle);
+    if (index < 0)
+    {
+        return false;
+    }
+    int last = Size() - 1;
+    if (index != last)
+    {
+        positions[index] = positions[last];
+        extents[index] = extents[last];
+        bodyIds[index] = bodyIds[last];
+        transforms[index] = transforms[last];
+        previousTransforms[index] = previousTransforms[last];
+        owners[index] = owners[last];
+        slotDense[owners[index].index] = static_cast<uint32_t>(index);
+    }
+    positions.pop_back();
+    extents.pop_back();
+    bodyIds.pop_back();
+    transforms.pop_back();
+    previousTransforms.pop_back();
+    owners.pop_back();
+    slotGeneration[handle.index]++;
+    freeSlots.push_back(handle.index);
+    return true;
+}
+
+void EntityStore::Clear()
+{
+    for (auto& owner : owners)
+    {
+        slotGeneration[owner.index]++;
+        freeSlots.push_back(owner.index);
+    }
+    positions.clear();
+    extents.clear();
+    bodyIds.clear();
+    transforms.clear();
+    previousTransforms.clear();
+    owners.clear();
+}
+
+int EntityStore::Find(EntityHandle handle) const
+{
+    if ((handle.index >= slotGeneration.size()) || (slotGeneration[handle.index] != handle.generation))
+    {
+        return -1;
+    }
+    return static_cast<int>(slotDense[handle.index]);
+}
+
+int EntityStore::FindSlot(uint32_t slot) const
+{
+    if (slot >= slotDense.size())
+    {
+        return -1;
+    }
+    uint32_t index = slotDense[slot];
+    return ((index < owners.size()) && (owners[index].index == slot)) ? static_cast<int>(index) : -1;
+}
+
+Rectangle EntityStore::Bounds(int index) const
+{
+    return Rectangle { positions[index].x, positions[index].y, extents[index].x, extents[index].y };
+}
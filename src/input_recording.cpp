@@ -0,0 +1,241 @@
+#include "input_recording.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "edit_history.h"
+#include "level.h"
+
+using namespace scene;
+
+//----------------------------------------------------------------------------------
+// Input recording layout (little endian)
+//
+//   FileHeader
+//   events                      step delta from the previous event, type byte, then a
+//                               and b stored as value + 1; every integer is a LEB128
+//                               varint so a typical event takes 3 to 5 bytes
+//----------------------------------------------------------------------------------
+
+namespace
+{
+    constexpr char recordingMagic[4] = { 'N', 'J', 'I', 'R' };
+    constexpr uint32_t recordingVersion = 1;
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        int32_t startLevel;
+        int32_t finalLevel;
+        uint32_t finalStep;
+        uint32_t eventCount;
+        uint64_t finalChecksum;
+    };
+
+    void writeVarint(std::vector<unsigned char>& buffer, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            buffer.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<unsigned char>(value));
+    }
+
+    bool readVarint(const unsigned char*& data, const unsigned char* end, uint32_t& value)
+    {
+        value = 0;
+        for (int shift = 0; (shift < 35) && (data < end); shift += 7)
+        {
+            unsigned char byte = *data++;
+            value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+}
+
+void InputRecording::Begin(int level)
+{
+    startLevel = level;
+    finalLevel = level;
+    finalStep = 0;
+    finalChecksum = 0;
+    events.clear();
+}
+
+void InputRecording::Record(int step, InputType type, int a, int b)
+{
+    events.push_back(InputEvent { static_cast<uint32_t>(step), type, a, b });
+}
+
+void InputRecording::Finish(int level, int step, uint64_t checksum)
+{
+    finalLevel = level;
+    finalStep = step;
+    finalChecksum = checksum;
+}
+
+bool InputRecording::Save(const std::string& path) const
+{
+    FileHeader header = {};
+    std::memcpy(header.magic, recordingMagic, sizeof(recordingMagic));
+    header.version = recordingVersion;
+    header.startLevel = startLevel;
+    header.finalLevel = finalLevel;
+    header.finalStep = static_cast<uint32_t>(finalStep);
+    header.eventCount = static_cast<uint32_t>(events.size());
+    header.finalChecksum = finalChecksum;
+
+    std::vector<unsigned char> buffer(sizeof(header));
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    uint32_t previousStep = 0;
+    for (auto& event : events)
+    {
+        // Restarts and level changes start the step count over for the events after them
+        writeVarint(buffer, event.step - previousStep);
+        buffer.push_back(static_cast<unsigned char>(event.type));
+        writeVarint(buffer, static_cast<uint32_t>(event.a + 1));
+        writeVarint(buffer, static_cast<uint32_t>(event.b + 1));
+        bool resets = (event.type == InputType::Restart) || (event.type == InputType::ChangeLevel);
+        previousStep = resets? 0 : event.step;
+    }
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    return static_cast<bool>(stream);
+}
+
+bool InputRecording::Load(const std::string& path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+    {
+        return false;
+    }
+    std::vector<unsigned char> buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    FileHeader header = {};
+    if (buffer.size() < sizeof(header))
+    {
+        return false;
+    }
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    if ((std::memcmp(header.magic, recordingMagic, sizeof(recordingMagic)) != 0) || (header.version != recordingVersion))
+    {
+        return false;
+    }
+
+    std::vector<InputEvent> loaded;
+    const unsigned char* data = buffer.data() + sizeof(header);
+    const unsigned char* end = buffer.data() + buffer.size();
+    uint32_t previousStep = 0;
+    for (uint32_t i = 0; i < header.eventCount; i++)
+    {
+        uint32_t delta = 0, a = 0, b = 0;
+        if (!readVarint(data, end, delta) || (data == end))
+        {
+            return false;
+        }
+        InputEvent event;
+        event.type = static_cast<InputType>(*data++);
+        if ((event.type > InputType::Redo) || !readVarint(data, end, a) || !readVarint(data, end, b))
+        {
+            return false;
+        }
+        event.step = previousStep + delta;
+        event.a = static_cast<int32_t>(a) - 1;
+        event.b = static_cast<int32_t>(b) - 1;
+        bool resets = (event.type == InputType::Restart) || (event.type == InputType::ChangeLevel);
+        previousStep = resets? 0 : event.step;
+        loaded.push_back(event);
+    }
+
+    startLevel = header.startLevel;
+    finalLevel = header.finalLevel;
+    finalStep = static_cast<int>(header.finalStep);
+    finalChecksum = header.finalChecksum;
+    events = std::move(loaded);
+    return true;
+}
+
+ReplayResult scene::ReplayInputs(const LevelProject& project, const InputRecording& recording, core::JobSystem* jobs)
+{
+    ReplayResult result;
+    int levelIndex = recording.GetStartLevel();
+    if ((levelIndex < 0) || (levelIndex >= project.Count()))
+    {
+        return result;
+    }
+
+    Level level;
+    level.SetJobSystem(jobs);
+    level.Build(project.Get(levelIndex));
+    EditHistory history;
+    auto validNode = [&level](int index) { return (index >= 0) && (index < level.Nodes().Size()); };
+    auto stepTo = [&](int step) {
+        while (level.GetStepCount() < step)
+        {
+            level.Step(Level::fixedTimeStep, level.GetSubStepCount());
+            result.totalSteps++;
+        }
+    };
+
+    for (auto& event : recording.Events())
+    {
+        stepTo(static_cast<int>(event.step));
+        switch (event.type)
+        {
+            case InputType::AddJoint:
+                if (validNode(event.a) && validNode(event.b))
+                {
+                    history.AddJoint(level, level.Nodes().HandleAt(event.a), level.Nodes().HandleAt(event.b));
+                }
+                break;
+            case InputType::RemoveJoint:
+                if ((event.a >= 0) && (event.a < level.JointBodies().Size()))
+                {
+                    history.RemoveJoint(level, level.JointBodies().HandleAt(event.a));
+                }
+                break;
+            case InputType::Undo:
+                history.Undo(level);
+                break;
+            case InputType::Redo:
+                history.Redo(level);
+                break;
+            case InputType::MoveCar:
+                level.MoveCar();
+                break;
+            case InputType::Restart:
+                level.Build(project.Get(levelIndex));
+                history.Clear();
+                break;
+            case InputType::ChangeLevel:
+                if ((event.a < 0) || (event.a >= project.Count()))
+                {
+                    return result;
+                }
+                levelIndex = event.a;
+                level.Build(project.Get(levelIndex));
+                history.Clear();
+                break;
+            case InputType::SubSteps:
+                level.SetSubStepCount(event.a);
+                break;
+            default:
+                // Selections and cancels only change what the player sees
+                break;
+        }
+    }
+    stepTo(recording.GetFinalStep());
+
+    result.valid = true;
+    result.finalLevel = levelIndex;
+    result.finalStep = level.GetStepCount();
+    result.checksum = level.ComputeChecksum();
+    result.matches = (result.finalLevel == recording.GetFinalLevel())
+        && (result.finalStep == recording.GetFinalStep())
+        && (result.checksum == recording.GetFinalChecksum());
+    return result;
+}
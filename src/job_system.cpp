@@ -0,0 +1,231 @@
+#include "job_system.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include "profiler.h"
+#include "trace_recorder.h"
+
+using namespace core;
+
+namespace
+{
+    constexpr int maxWorkerCount = 32;
+    constexpr int spinCount = 64;
+}
+
+JobSystem::JobSystem(int workerCount)
+{
+#if defined(PLATFORM_WEB)
+    workerCount = 1;
+#endif
+    this->workerCount = std::clamp(workerCount, 1, maxWorkerCount);
+    for (int i = 0; i < this->workerCount; i++)
+    {
+        queues.emplace_back(std::make_unique<WorkerQueue>());
+    }
+    // The last worker index belongs to the thread that steps the world
+    for (int i = 0; i < this->workerCount - 1; i++)
+    {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        running = false;
+    }
+    wakeCondition.notify_all();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+int JobSystem::DefaultWorkerCount()
+{
+    if (const char* value = std::getenv("NEXTJAM_WORKERS"))
+    {
+        int count = std::atoi(value);
+        if (count > 0)
+        {
+            return std::min(count, maxWorkerCount);
+        }
+    }
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    return std::clamp(hardware, 1, 8);
+}
+
+void JobSystem::ConfigureWorld(b2WorldDef& worldDef)
+{
+    if (workerCount <= 1)
+    {
+        return;
+    }
+    worldDef.workerCount = workerCount;
+    worldDef.enqueueTask = &JobSystem::EnqueueTask;
+    worldDef.finishTask = &JobSystem::FinishTask;
+    worldDef.userTaskContext = this;
+}
+
+void* JobSystem::EnqueueTask(b2TaskCallback* task, int itemCount, int minRange, void* taskContext, void* userContext)
+{
+    return static_cast<JobSystem*>(userContext)->enqueue(task, itemCount, minRange, taskContext);
+}
+
+void JobSystem::FinishTask(void* userTask, void* userContext)
+{
+    if (userTask)
+    {
+        static_cast<JobSystem*>(userContext)->finish(static_cast<Task*>(userTask));
+    }
+}
+
+void* JobSystem::enqueue(b2TaskCallback* callback, int itemCount, int minRange, void* context)
+{
+    int callerIndex = workerCount - 1;
+    if (itemCount <= 0)
+    {
+        return nullptr;
+    }
+    // Single-item tasks are still queued: the solver enqueues one per worker and they
+    // spin on each other, so running one inline here would deadlock the step
+    if (workerCount <= 1)
+    {
+        callback(0, itemCount, callerIndex, context);
+        return nullptr;
+    }
+
+    minRange = std::max(minRange, 1);
+    int jobCount = std::min(workerCount, std::max(1, itemCount / minRange));
+    int chunkSize = (itemCount + jobCount - 1) / jobCount;
+    jobCount = (itemCount + chunkSize - 1) / chunkSize;
+
+    Task* task = acquireTask();
+    task->callback = callback;
+    task->context = context;
+    task->pendingJobs.store(jobCount, std::memory_order_relaxed);
+
+    int threadCount = static_cast<int>(threads.size());
+    for (int start = 0; start < itemCount; start += chunkSize)
+    {
+        WorkerQueue& queue = *queues[nextQueue];
+        nextQueue = (nextQueue + 1) % threadCount;
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(Job { task, start, std::min(start + chunkSize, itemCount) });
+    }
+    queuedJobs.fetch_add(jobCount, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_all();
+    return task;
+}
+
+void JobSystem::finish(Task* task)
+{
+    int callerIndex = workerCount - 1;
+    Job job;
+    while (task->pendingJobs.load(std::memory_order_acquire) > 0)
+    {
+        if (popJob(callerIndex, job))
+        {
+            runJob(job, callerIndex);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    releaseTask(task);
+}
+
+void JobSystem::workerLoop(int workerIndex)
+{
+#if defined(NEXTJAM_PROFILER)
+    TraceRecorder::SetThreadName(("job worker " + std::to_string(workerIndex)).c_str());
+#endif
+    Job job;
+    while (running)
+    {
+        bool found = false;
+        for (int spin = 0; spin < spinCount && !found; spin++)
+        {
+            found = popJob(workerIndex, job);
+            if (!found)
+            {
+                std::this_thread::yield();
+            }
+        }
+        if (found)
+        {
+            runJob(job, workerIndex);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this]() {
+            return queuedJobs.load(std::memory_order_acquire) > 0 || !running;
+        });
+    }
+}
+
+bool JobSystem::popJob(int workerIndex, Job& job)
+{
+    if (queuedJobs.load(std::memory_order_acquire) <= 0)
+    {
+        return false;
+    }
+    // Own queue first, newest job, then steal the oldest job from the others
+    {
+        WorkerQueue& own = *queues[workerIndex];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty())
+        {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+    for (int i = 1; i < workerCount; i++)
+    {
+        WorkerQueue& victim = *queues[(workerIndex + i) % workerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::runJob(const Job& job, int workerIndex)
+{
+    PROFILE_SCOPE("b2 task");
+    job.task->callback(job.startIndex, job.endIndex, static_cast<uint32_t>(workerIndex), job.task->context);
+    job.task->pendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+JobSystem::Task* JobSystem::acquireTask()
+{
+    std::lock_guard<std::mutex> lock(taskMutex);
+    if (freeTasks.empty())
+    {
+        taskPool.emplace_back(std::make_unique<Task>());
+        return taskPool.back().get();
+    }
+    Task* task = freeTasks.back();
+    freeTasks.pop_back();
+    return task;
+}
+
+void JobSystem::releaseTask(Task* task)
+{
+    std::lock_guard<std::mutex> lock(taskMutex);
+    freeTasks.push_back(task);
+}
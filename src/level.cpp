@@ -0,0 +1,518 @@
+#include "level.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include "profiler.h"
+#include "raymath.h"
+
+using namespace scene;
+
+namespace
+{
+    bool wakeBeam(b2ShapeId shapeId, void*)
+    {
+        b2BodyId bodyId = b2Shape_GetBody(shapeId);
+        if (b2Body_GetUserData(bodyId) && !b2Body_IsAwake(bodyId))
+        {
+            b2Body_SetAwake(bodyId, true);
+        }
+        return true;
+    }
+
+    // Box2D keeps worlds in a global table, so creating and destroying them from several
+    // threads at once (BridgeEvaluator workers, the level preloader and the main thread)
+    // has to be serialised
+    std::mutex worldTableMutex;
+}
+
+Level::~Level()
+{
+    Destroy();
+}
+
+void Level::createB2World()
+{
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    worldDef.gravity.y = 9.8f * 50;
+    if (jobSystem)
+    {
+        jobSystem->ConfigureWorld(worldDef);
+    }
+    std::lock_guard<std::mutex> lock(worldTableMutex);
+    worldId = b2CreateWorld(&worldDef);
+}
+
+// Static geometry is all shapes on one ground body at the origin, the entity only
+// keeps the rectangle for picking and debug drawing
+void Level::createGroundShape(b2BodyId groundId, Rectangle rect)
+{
+    auto b2width = rect.width / 2.0f;
+    auto b2height = rect.height / 2.0f;
+    b2Transform center = { { rect.x + b2width, rect.y + b2height }, b2Rot_identity };
+    b2Polygon groundBox = b2MakeBox(b2width, b2height);
+    groundBox = b2TransformPolygon(center, &groundBox);
+    b2ShapeDef groundShapeDef = b2DefaultShapeDef();
+    b2CreatePolygonShape(groundId, &groundShapeDef, &groundBox);
+    groundEntities.Create({ rect.x, rect.y }, { rect.width, rect.height });
+}
+
+EntityHandle Level::createNodeEntity(Rectangle rect)
+{
+    auto b2width = rect.width / 2.0f;
+    auto b2height = rect.height / 2.0f;
+
+    b2BodyDef bodyDef = b2DefaultBodyDef();
+    bodyDef.position = { rect.x + b2width, rect.y + b2height };
+    b2BodyId nodeId = b2CreateBody(worldId.value(), &bodyDef);
+
+    b2Polygon nodeBox = b2MakeBox(b2width, b2height);
+    b2ShapeDef nodeShapeDef = b2DefaultShapeDef();
+    b2CreatePolygonShape(nodeId, &nodeShapeDef, &nodeBox);
+    return nodeEntities.Create({ rect.x, rect.y }, { rect.width, rect.height }, nodeId);
+}
+
+void Level::Build(const LevelData& data)
+{
+    Destroy();
+    createB2World();
+
+    if (data.hasCar)
+    {
+        float m_torque = 90000.0f;
+        float m_hertz = 25.0f;
+        float m_dampingRatio = 0.7f;
+        m_car.Spawn(worldId.value(), { data.carPosition.x, data.carPosition.y }, 10.0f, m_hertz, m_dampingRatio, m_torque);
+    }
+    b2BodyDef groundDef = b2DefaultBodyDef();
+    b2BodyId groundId = b2CreateBody(worldId.value(), &groundDef);
+    for (auto& rect : data.statics)
+    {
+        createGroundShape(groundId, rect);
+    }
+    for (auto& rect : data.terrain)
+    {
+        createGroundShape(groundId, rect);
+    }
+    for (auto& rect : data.nodes)
+    {
+        createNodeEntity(rect);
+    }
+    nodeGridDirty = true;
+    passedArea = data.passed;
+    loseArea = data.lose;
+    state = LevelState::PLAYING;
+    accumulator = 0.0f;
+    stepCount = 0;
+    awakeBodyCount = 0;
+    currentSubSteps = defaultSubStepCount;
+    subStepController.Reset();
+    stepMeasured = false;
+}
+
+void Level::Destroy()
+{
+    if (!worldId)
+    {
+        return;
+    }
+    if (m_car.IsSpawned())
+    {
+        m_car.Despawn();
+    }
+    {
+        std::lock_guard<std::mutex> lock(worldTableMutex);
+        b2DestroyWorld(worldId.value());
+    }
+    worldId.reset();
+    groundEntities.Clear();
+    nodeEntities.Clear();
+    nodeGrid.Clear();
+    nodeGridDirty = true;
+    jointEntities.clear();
+    jointBodyEntities.Clear();
+    passedArea = { 0.0f, 0.0f, 0.0f, 0.0f };
+    loseArea = { 0.0f, 0.0f, 0.0f, 0.0f };
+    state = LevelState::PLAYING;
+}
+
+int Level::Update(float frameTime)
+{
+    int steps = 0;
+    if (adaptiveSubSteps)
+    {
+        updateSubSteps();
+    }
+    accumulator += frameTime;
+    while ((accumulator >= fixedTimeStep) && (steps < maxCatchUpSteps))
+    {
+        Step(fixedTimeStep, currentSubSteps);
+        accumulator -= fixedTimeStep;
+        steps++;
+    }
+    // Drop the whole steps we could not catch up on instead of spiralling on the next
+    // frames; the fraction left keeps the interpolation alpha below 1
+    if (accumulator >= fixedTimeStep)
+    {
+        accumulator = std::fmod(accumulator, fixedTimeStep);
+    }
+    return steps;
+}
+
+void Level::Step(float timeStep, int subStepCount)
+{
+    if (!worldId)
+    {
+        return;
+    }
+    PROFILE_SCOPE("Level::Step");
+    storePreviousTransforms();
+    wakeBodiesNearCar();
+    if (adaptiveSubSteps)
+    {
+        auto start = std::chrono::steady_clock::now();
+        b2World_Step(worldId.value(), timeStep, subStepCount);
+        lastStepMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stepMeasured = true;
+    }
+    else
+    {
+        b2World_Step(worldId.value(), timeStep, subStepCount);
+    }
+    PROFILE_WORLD(worldId.value());
+    applyBodyMoveEvents();
+    stepCount++;
+    checkCarCollision();
+}
+
+// Beams sleep once the bridge settles. Each beam is welded only to static nodes, so it is
+// its own island until something touches it: wake the ones the car is about to reach a
+// step early instead of waiting for a contact against a sleeping body.
+void Level::wakeBodiesNearCar()
+{
+    if (!m_car.IsSpawned() || jointBodyEntities.Empty() || !b2Body_IsAwake(m_car.GetChassisId()))
+    {
+        return;
+    }
+    b2AABB bounds = b2Body_ComputeAABB(m_car.GetChassisId());
+    bounds = b2AABB_Union(bounds, b2Body_ComputeAABB(m_car.GetRearWheelId()));
+    bounds = b2AABB_Union(bounds, b2Body_ComputeAABB(m_car.GetFrontWheelId()));
+    bounds.lowerBound = b2Sub(bounds.lowerBound, { carWakeMargin, carWakeMargin });
+    bounds.upperBound = b2Add(bounds.upperBound, { carWakeMargin, carWakeMargin });
+    b2World_OverlapAABB(worldId.value(), bounds, b2DefaultQueryFilter(), wakeBeam, nullptr);
+}
+
+void Level::SetAdaptiveSubSteps(bool enabled, const SubStepOptions& options)
+{
+    adaptiveSubSteps = enabled;
+    subStepController = SubStepController(options);
+}
+
+// Decided once per frame from the steps of the previous one, so the count only ever
+// changes between steps and an input recording can carry it like any other input
+void Level::updateSubSteps()
+{
+    if (!worldId || !stepMeasured)
+    {
+        return;
+    }
+    stepMeasured = false;
+    currentSubSteps = subStepController.Update(currentSubSteps, MeasureJointError(), lastStepMs);
+}
+
+// Largest distance between the two anchors of an awake weld, sleeping beams are settled
+float Level::MeasureJointError() const
+{
+    float error = 0.0f;
+    for (auto& joint : jointEntities)
+    {
+        b2BodyId bodyA = b2Joint_GetBodyA(joint.id);
+        b2BodyId bodyB = b2Joint_GetBodyB(joint.id);
+        if (!b2Body_IsAwake(bodyA) && !b2Body_IsAwake(bodyB))
+        {
+            continue;
+        }
+        b2Vec2 anchorA = b2Body_GetWorldPoint(bodyA, b2Joint_GetLocalAnchorA(joint.id));
+        b2Vec2 anchorB = b2Body_GetWorldPoint(bodyB, b2Joint_GetLocalAnchorB(joint.id));
+        error = std::max(error, b2Distance(anchorA, anchorB));
+    }
+    return error;
+}
+
+void Level::storePreviousTransforms()
+{
+    m_car.StorePreviousTransforms();
+    jointBodyEntities.SnapshotTransforms();
+}
+
+// Only bodies that moved are reported, so the cached transforms of sleeping beams stay
+// valid. Beam bodies carry their store slot + 1 as user data; everything else has none.
+void Level::applyBodyMoveEvents()
+{
+    b2BodyEvents events = b2World_GetBodyEvents(worldId.value());
+    awakeBodyCount = events.moveCount;
+    for (int i = 0; i < events.moveCount; i++)
+    {
+        const b2BodyMoveEvent& event = events.moveEvents[i];
+        if (!event.userData)
+        {
+            continue;
+        }
+        auto slot = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(event.userData) - 1);
+        int index = jointBodyEntities.FindSlot(slot);
+        if (index >= 0)
+        {
+            jointBodyEntities.SetTransform(index, event.transform);
+        }
+    }
+}
+
+b2Transform Level::GetInterpolatedTransform(const EntityStore& store, int index) const
+{
+    return LerpTransform(store.PreviousTransform(index), store.Transform(index), GetAlpha());
+}
+
+// FNV-1a over the state of every dynamic body, in creation order: two runs that took
+// the same inputs on the same steps produce the same value
+uint64_t Level::ComputeChecksum() const
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        auto bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    auto mixBody = [&mix](b2BodyId bodyId) {
+        b2Transform transform = b2Body_GetTransform(bodyId);
+        b2Vec2 velocity = b2Body_GetLinearVelocity(bodyId);
+        float angularVelocity = b2Body_GetAngularVelocity(bodyId);
+        mix(&transform, sizeof(transform));
+        mix(&velocity, sizeof(velocity));
+        mix(&angularVelocity, sizeof(angularVelocity));
+    };
+    mix(&stepCount, sizeof(stepCount));
+    mix(&state, sizeof(state));
+    if (!worldId)
+    {
+        return hash;
+    }
+    if (m_car.IsSpawned())
+    {
+        mixBody(m_car.GetChassisId());
+        mixBody(m_car.GetRearWheelId());
+        mixBody(m_car.GetFrontWheelId());
+    }
+    for (int i = 0; i < jointBodyEntities.Size(); i++)
+    {
+        mixBody(jointBodyEntities.BodyId(i));
+    }
+    return hash;
+}
+
+void Level::MoveCar()
+{
+    if (m_car.IsSpawned())
+    {
+        m_car.SetSpeed(150.0f);
+    }
+}
+
+void Level::checkCarCollision()
+{
+    if (!m_car.IsSpawned())
+    {
+        return;
+    }
+    Vector2 carPosition = m_car.GetPosition();
+    if (CheckCollisionPointRec(carPosition, passedArea) && state != LevelState::PASSED)
+    {
+        state = LevelState::PASSED;
+        m_car.SetSpeed(0.0f);
+    }
+
+    if (CheckCollisionPointRec(carPosition, loseArea) && state != LevelState::LOSE)
+    {
+        state = LevelState::LOSE;
+        m_car.SetSpeed(0.0f);
+    }
+}
+
+bool Level::AddJoint(int nodeA, int nodeB)
+{
+    auto count = nodeEntities.Size();
+    if (nodeA < 0 || nodeB < 0 || nodeA >= count || nodeB >= count || nodeA == nodeB)
+    {
+        return false;
+    }
+    return AddJoint(nodeEntities.HandleAt(nodeA), nodeEntities.HandleAt(nodeB)).IsValid();
+}
+
+EntityHandle Level::AddJoint(EntityHandle nodeA, EntityHandle nodeB)
+{
+    int indexA = nodeEntities.Find(nodeA);
+    int indexB = nodeEntities.Find(nodeB);
+    if (indexA < 0 || indexB < 0 || indexA == indexB)
+    {
+        return { };
+    }
+    Vector2 posA = nodeEntities.Position(indexA);
+    Vector2 posB = nodeEntities.Position(indexB);
+    if (posA.x > posB.x) {
+        std::swap(nodeA, nodeB);
+        std::swap(indexA, indexB);
+        std::swap(posA, posB);
+    }
+    b2Vec2 extentA = nodeEntities.Extent(indexA);
+    auto width = Vector2Distance(posA, posB);
+    auto boxWidth = width / 2.0f - 8.0f;
+    auto boxHeight = 5.f;
+    b2Polygon box = b2MakeBox(boxWidth, boxHeight);
+    b2ShapeDef shapeDef = b2DefaultShapeDef();
+    b2BodyDef bodyDef = b2DefaultBodyDef();
+    bodyDef.type = b2_dynamicBody;
+    bodyDef.position = { posA.x + width / 2.0f + extentA.x / 2.0f + 2.0f, posA.y + boxHeight - extentA.y + 2.0f};
+    auto bodyId = b2CreateBody(worldId.value(), &bodyDef);
+    b2CreatePolygonShape(bodyId, &shapeDef, &box);
+    EntityHandle beam = jointBodyEntities.Create({ posA.x + 7.0f, posA.y }, { boxWidth * 2.0f, boxHeight * 2.0f }, bodyId);
+    b2Body_SetUserData(bodyId, reinterpret_cast<void*>(static_cast<uintptr_t>(beam.index) + 1));
+
+    auto jointDef = b2DefaultWeldJointDef();
+    b2Vec2 pivot = { 0.0f, 0.5f };
+    jointDef.bodyIdA = nodeEntities.BodyId(indexA);
+    jointDef.bodyIdB = bodyId;
+    jointDef.localAnchorA = b2Body_GetLocalPoint(jointDef.bodyIdA, {0.5f, 0.5f});
+    jointDef.localAnchorB = b2Body_GetLocalPoint(jointDef.bodyIdB, pivot);
+    jointDef.angularHertz = 20.0f;
+    jointDef.angularDampingRatio = 10.0f;
+    jointDef.linearHertz = 10.0f;
+    jointDef.linearDampingRatio = 15.0f;
+    jointDef.collideConnected = true;
+    auto id = b2CreateWeldJoint(worldId.value(), &jointDef);
+    jointEntities.push_back(Joint { nodeA, beam, id });
+
+    pivot = { 1.0f, 0.5f };
+    jointDef.bodyIdA = bodyId;
+    jointDef.bodyIdB = nodeEntities.BodyId(indexB);
+    jointDef.localAnchorA = b2Body_GetLocalPoint(jointDef.bodyIdA, pivot);
+    jointDef.localAnchorB = b2Body_GetLocalPoint(jointDef.bodyIdB, {0.5f, 0.5f});
+    jointDef.angularHertz = 20.0f;
+    jointDef.angularDampingRatio = 10.0f;
+    jointDef.linearHertz = 10.0f;
+    jointDef.linearDampingRatio = 15.0f;
+    jointDef.collideConnected = true;
+    id = b2CreateWeldJoint(worldId.value(), &jointDef);
+    jointEntities.push_back(Joint { nodeB, beam, id });
+    return beam;
+}
+
+// Destroying the beam body also destroys both welds attached to it. The welds are kept
+// in pairs in the beams' dense order, so they follow the store's swap with the last beam.
+bool Level::RemoveJoint(EntityHandle beam)
+{
+    int index = jointBodyEntities.Find(beam);
+    if (index < 0)
+    {
+        return false;
+    }
+    int last = jointBodyEntities.Size() - 1;
+    b2DestroyBody(jointBodyEntities.BodyId(index));
+    jointBodyEntities.Destroy(beam);
+    jointEntities[2*index] = jointEntities[2*last];
+    jointEntities[2*index + 1] = jointEntities[2*last + 1];
+    jointEntities.resize(2*last);
+    return true;
+}
+
+std::pair<EntityHandle, EntityHandle> Level::BeamNodes(EntityHandle beam) const
+{
+    int index = jointBodyEntities.Find(beam);
+    if (index < 0)
+    {
+        return { };
+    }
+    return { jointEntities[2*index].node, jointEntities[2*index + 1].node };
+}
+
+EntityHandle Level::PickBeam(Vector2 point)
+{
+    if (!worldId || jointBodyEntities.Empty())
+    {
+        return { };
+    }
+    struct Query
+    {
+        const EntityStore* beams;
+        b2Vec2 point;
+        EntityHandle found;
+    } query = { &jointBodyEntities, { point.x, point.y }, { } };
+    b2AABB bounds = { { point.x - 1.0f, point.y - 1.0f }, { point.x + 1.0f, point.y + 1.0f } };
+    b2World_OverlapAABB(worldId.value(), bounds, b2DefaultQueryFilter(), [](b2ShapeId shapeId, void* context) {
+        auto* query = static_cast<Query*>(context);
+        auto slot = reinterpret_cast<uintptr_t>(b2Body_GetUserData(b2Shape_GetBody(shapeId)));
+        if ((slot == 0) || !b2Shape_TestPoint(shapeId, query->point))
+        {
+            return true;
+        }
+        int index = query->beams->FindSlot(static_cast<uint32_t>(slot - 1));
+        if (index >= 0)
+        {
+            query->found = query->beams->HandleAt(index);
+        }
+        return index < 0;
+    }, &query);
+    return query.found;
+}
+
+EntityHandle Level::AddNode(Vector2 position)
+{
+    b2Vec2 extent = { 8.0f, 8.0f };
+    auto b2width = extent.x / 2.0f;
+    auto b2height = extent.y / 2.0f;
+
+    auto centerX = position.x + b2width;
+    auto centerY = position.y + b2height;
+
+    b2BodyDef bodyDef = b2DefaultBodyDef();
+    bodyDef.position = { centerX, centerY };
+
+    b2BodyId groundId = b2CreateBody(worldId.value(), &bodyDef);
+
+    b2Polygon groundBox = b2MakeBox(b2width, b2height);
+    b2ShapeDef groundShapeDef = b2DefaultShapeDef();
+    b2CreatePolygonShape(groundId, &groundShapeDef, &groundBox);
+    nodeGridDirty = true;
+    return nodeEntities.Create(position, extent, groundId);
+}
+
+// Same hit area as the mouse mark drawn around a node: grown by the margin up and left
+EntityHandle Level::PickNode(Vector2 point)
+{
+    if (nodeGridDirty)
+    {
+        rebuildNodeGrid();
+    }
+    int index = nodeGrid.Query(point);
+    return (index >= 0) ? nodeEntities.HandleAt(index) : EntityHandle { };
+}
+
+void Level::rebuildNodeGrid()
+{
+    std::vector<Rectangle> rects;
+    rects.reserve(nodeEntities.Size());
+    for (int i = 0; i < nodeEntities.Size(); i++)
+    {
+        Rectangle bounds = nodeEntities.Bounds(i);
+        rects.push_back(Rectangle {
+            bounds.x - nodePickMargin,
+            bounds.y - nodePickMargin,
+            bounds.width + nodePickMargin,
+            bounds.height + nodePickMargin
+        });
+    }
+    nodeGrid.Build(rects);
+    nodeGridDirty = false;
+}
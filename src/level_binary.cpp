@@ -0,0 +1,291 @@
+#include "level_data.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include "mapped_file.h"
+
+using namespace scene;
+
+//----------------------------------------------------------------------------------
+// levels.bin layout (little endian)
+//
+//   FileHeader
+//   LevelRecord[levelCount]     offset/size of every level block from the file start
+//   level blocks                fields in the order written by writeLevel(), strings and
+//                               arrays prefixed by a u32 count and padded to 4 bytes
+//
+// Tiles are packed to 12 bytes: source x/y with the flip flags in the top bits, then the
+// signed target position. Every block is self-contained so a level is decoded only when
+// needed. Tiles that do not fit (a tileset past 32767 px) fail the save instead of
+// being written wrong.
+//----------------------------------------------------------------------------------
+
+namespace
+{
+    constexpr char levelMagic[4] = { 'N', 'J', 'L', 'V' };
+    constexpr uint32_t levelVersion = 2;
+    constexpr uint16_t tileFlipX = 0x8000;
+    constexpr uint16_t tileFlipY = 0x8000;
+    constexpr uint16_t tileCoordMask = 0x7fff;
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t levelCount;
+        uint32_t reserved;
+    };
+
+    struct PackedTile
+    {
+        uint16_t sourceX;   // top bit: flipX
+        uint16_t sourceY;   // top bit: flipY
+        int32_t x;
+        int32_t y;
+    };
+
+    bool fitsSource(float coord)
+    {
+        return (coord >= 0.0f) && (coord <= float(tileCoordMask));
+    }
+
+    // Exclusive bound: 2^31 itself does not convert to int32_t
+    bool fitsPosition(float coord)
+    {
+        return (coord >= -2147483648.0f) && (coord < 2147483648.0f);
+    }
+
+    class Writer
+    {
+    public:
+        void U32(uint32_t value) { Raw(&value, sizeof(value)); }
+        void F32(float value) { Raw(&value, sizeof(value)); }
+        void Rect(const Rectangle& rect) { Raw(&rect, sizeof(rect)); }
+        void String(const std::string& text)
+        {
+            U32(static_cast<uint32_t>(text.size()));
+            Raw(text.data(), text.size());
+            Pad();
+        }
+        void Rects(const std::vector<Rectangle>& rects)
+        {
+            U32(static_cast<uint32_t>(rects.size()));
+            Raw(rects.data(), rects.size()*sizeof(Rectangle));
+        }
+        void Raw(const void* data, size_t size)
+        {
+            auto bytes = static_cast<const unsigned char*>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+        }
+        void Pad()
+        {
+            while (buffer.size() % 4) buffer.push_back(0);
+        }
+        std::vector<unsigned char> buffer;
+    };
+
+    class Reader
+    {
+    public:
+        Reader(const unsigned char* data, size_t size) : data(data), size(size) {}
+
+        bool Raw(void* out, size_t count)
+        {
+            if (count > size - offset) return ok = false;
+            if (count) std::memcpy(out, data + offset, count);
+            offset += count;
+            return true;
+        }
+        uint32_t U32() { uint32_t value = 0; Raw(&value, sizeof(value)); return value; }
+        float F32() { float value = 0.0f; Raw(&value, sizeof(value)); return value; }
+        Rectangle Rect() { Rectangle rect = { 0.0f, 0.0f, 0.0f, 0.0f }; Raw(&rect, sizeof(rect)); return rect; }
+        std::string String()
+        {
+            uint32_t length = U32();
+            if (!ok || (length > size - offset)) { ok = false; return {}; }
+            std::string text(reinterpret_cast<const char*>(data + offset), length);
+            offset += length;
+            offset = std::min(size, (offset + 3) & ~size_t(3));
+            return text;
+        }
+        void Rects(std::vector<Rectangle>& rects)
+        {
+            uint32_t count = U32();
+            if (!ok || (count > (size - offset)/sizeof(Rectangle))) { ok = false; return; }
+            rects.resize(count);
+            Raw(rects.data(), count*sizeof(Rectangle));
+        }
+        bool ok = true;
+    private:
+        const unsigned char* data;
+        size_t size;
+        size_t offset = 0;
+    };
+
+    bool writeLevel(Writer& writer, const LevelData& data)
+    {
+        writer.String(data.name);
+        writer.F32(data.size.x);
+        writer.F32(data.size.y);
+        writer.String(data.background);
+        writer.U32(data.hasCar? 1 : 0);
+        writer.F32(data.carPosition.x);
+        writer.F32(data.carPosition.y);
+        writer.Rect(data.passed);
+        writer.Rect(data.lose);
+        writer.Rects(data.statics);
+        writer.Rects(data.nodes);
+        writer.Rects(data.terrain);
+        writer.U32(static_cast<uint32_t>(data.tileLayers.size()));
+        for (auto& layer : data.tileLayers)
+        {
+            writer.String(layer.tileset);
+            writer.F32(layer.tiles.empty()? 0.0f : std::abs(layer.tiles.front().source.width));
+            writer.U32(static_cast<uint32_t>(layer.tiles.size()));
+            for (auto& tile : layer.tiles)
+            {
+                if (!fitsSource(tile.source.x) || !fitsSource(tile.source.y) || !fitsPosition(tile.position.x) || !fitsPosition(tile.position.y))
+                {
+                    TraceLog(LOG_WARNING, "LEVEL: Tile at (%.0f, %.0f) in %s does not fit levels.bin", tile.position.x, tile.position.y, data.name.c_str());
+                    return false;
+                }
+                PackedTile packed = {
+                    static_cast<uint16_t>((static_cast<uint16_t>(tile.source.x) & tileCoordMask) | ((tile.source.width < 0.0f)? tileFlipX : 0)),
+                    static_cast<uint16_t>((static_cast<uint16_t>(tile.source.y) & tileCoordMask) | ((tile.source.height < 0.0f)? tileFlipY : 0)),
+                    static_cast<int32_t>(tile.position.x),
+                    static_cast<int32_t>(tile.position.y)
+                };
+                writer.Raw(&packed, sizeof(packed));
+            }
+        }
+        return true;
+    }
+}
+
+bool LevelProject::LoadFromBinary(const std::string& path)
+{
+    auto file = std::make_unique<core::MappedFile>();
+    if (!file->Open(path) || !LoadFromMemory(file->Data(), file->Size(), path))
+    {
+        return false;
+    }
+    binary = std::move(file);
+    return true;
+}
+
+bool LevelProject::LoadFromMemory(const unsigned char* data, size_t size, const std::string& name)
+{
+    levels.clear();
+    records.clear();
+    binary.reset();
+    binaryData = nullptr;
+
+    Reader reader(data, size);
+    FileHeader header = {};
+    reader.Raw(&header, sizeof(header));
+    if (!reader.ok || (std::memcmp(header.magic, levelMagic, sizeof(levelMagic)) != 0) || (header.version != levelVersion))
+    {
+        TraceLog(LOG_WARNING, "LEVEL: %s is not a compiled level file of version %u", name.c_str(), levelVersion);
+        return false;
+    }
+    records.resize(header.levelCount);
+    for (auto& record : records)
+    {
+        record.offset = reader.U32();
+        record.size = reader.U32();
+        if (!reader.ok || (record.offset > size) || (record.size > size - record.offset))
+        {
+            TraceLog(LOG_WARNING, "LEVEL: Truncated level table in %s", name.c_str());
+            records.clear();
+            return false;
+        }
+    }
+    binaryData = data;
+    levels.resize(records.size());
+    return true;
+}
+
+bool LevelProject::decodeBinary(int index, LevelData& data) const
+{
+    if (!binaryData || (index < 0) || (index >= static_cast<int>(records.size())))
+    {
+        return false;
+    }
+    const BinaryRecord& record = records[index];
+    Reader reader(binaryData + record.offset, record.size);
+    data.name = reader.String();
+    data.size.x = reader.F32();
+    data.size.y = reader.F32();
+    data.background = reader.String();
+    data.hasCar = reader.U32() != 0;
+    data.carPosition.x = reader.F32();
+    data.carPosition.y = reader.F32();
+    data.passed = reader.Rect();
+    data.lose = reader.Rect();
+    reader.Rects(data.statics);
+    reader.Rects(data.nodes);
+    reader.Rects(data.terrain);
+    uint32_t layerCount = reader.U32();
+    for (uint32_t i = 0; (i < layerCount) && reader.ok; i++)
+    {
+        TileLayerData layer;
+        layer.tileset = reader.String();
+        float tileSize = reader.F32();
+        uint32_t tileCount = reader.U32();
+        if (!reader.ok || (tileCount > record.size/sizeof(PackedTile)))
+        {
+            return false;
+        }
+        layer.tiles.resize(tileCount);
+        for (auto& tile : layer.tiles)
+        {
+            PackedTile packed = {};
+            reader.Raw(&packed, sizeof(packed));
+            tile.source = {
+                float(packed.sourceX & tileCoordMask),
+                float(packed.sourceY & tileCoordMask),
+                (packed.sourceX & tileFlipX)? -tileSize : tileSize,
+                (packed.sourceY & tileFlipY)? -tileSize : tileSize
+            };
+            tile.position = { float(packed.x), float(packed.y) };
+        }
+        data.tileLayers.emplace_back(std::move(layer));
+    }
+    return reader.ok;
+}
+
+bool LevelProject::SaveBinary(const std::string& path) const
+{
+    std::vector<Writer> blocks(Count());
+    for (int i = 0; i < Count(); i++)
+    {
+        if (!writeLevel(blocks[i], Get(i)))
+        {
+            return false;
+        }
+    }
+
+    Writer file;
+    FileHeader header = {};
+    std::memcpy(header.magic, levelMagic, sizeof(levelMagic));
+    header.version = levelVersion;
+    header.levelCount = static_cast<uint32_t>(blocks.size());
+    file.Raw(&header, sizeof(header));
+    uint32_t offset = static_cast<uint32_t>(sizeof(FileHeader) + blocks.size()*sizeof(BinaryRecord));
+    for (auto& block : blocks)
+    {
+        file.U32(offset);
+        file.U32(static_cast<uint32_t>(block.buffer.size()));
+        offset += static_cast<uint32_t>(block.buffer.size());
+    }
+    for (auto& block : blocks)
+    {
+        file.Raw(block.buffer.data(), block.buffer.size());
+    }
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char*>(file.buffer.data()), file.buffer.size());
+    return static_cast<bool>(stream);
+}
@@ -0,0 +1,221 @@
+#include "level_data.h"
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <LDtkLoader/Project.hpp>
+#include <LDtkLoader/World.hpp>
+#include "mapped_file.h"
+
+using namespace scene;
+
+namespace
+{
+    Rectangle entityRect(const ldtk::Entity& entity)
+    {
+        return Rectangle {
+            static_cast<float>(entity.getPosition().x),
+            static_cast<float>(entity.getPosition().y),
+            static_cast<float>(entity.getSize().x),
+            static_cast<float>(entity.getSize().y)
+        };
+    }
+}
+
+std::vector<Rectangle> scene::MergeSolidCells(const std::vector<uint8_t>& solid, int columns, int rows, float cellSize, Vector2 offset)
+{
+    std::vector<Rectangle> boxes;
+    std::vector<uint8_t> used(solid.size(), 0);
+    auto isFree = [&](int x, int y) {
+        auto index = static_cast<size_t>(y)*columns + x;
+        return solid[index] && !used[index];
+    };
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < columns; x++)
+        {
+            if (!isFree(x, y))
+            {
+                continue;
+            }
+            int width = 1;
+            while ((x + width < columns) && isFree(x + width, y))
+            {
+                width++;
+            }
+            int height = 1;
+            for (bool grow = true; grow && (y + height < rows); )
+            {
+                for (int i = 0; i < width; i++)
+                {
+                    if (!isFree(x + i, y + height))
+                    {
+                        grow = false;
+                        break;
+                    }
+                }
+                if (grow)
+                {
+                    height++;
+                }
+            }
+            for (int row = y; row < y + height; row++)
+            {
+                std::fill_n(used.begin() + static_cast<size_t>(row)*columns + x, width, uint8_t(1));
+            }
+            boxes.push_back(Rectangle {
+                offset.x + x*cellSize,
+                offset.y + y*cellSize,
+                width*cellSize,
+                height*cellSize
+            });
+            x += width - 1;
+        }
+    }
+    return boxes;
+}
+
+LevelProject::LevelProject() = default;
+
+LevelProject::~LevelProject() = default;
+
+bool LevelProject::LoadFromLdtk(const std::string& path)
+{
+    levels.clear();
+    records.clear();
+    binary.reset();
+    binaryData = nullptr;
+    try
+    {
+        ldtk::Project project;
+        project.loadFromFile(path);
+        const auto& world = project.getWorld();
+        auto count = static_cast<int>(world.allLevels().size());
+        levels.reserve(count);
+        for (int i = 0; i < count; i++)
+        {
+            levels.emplace_back(std::make_unique<LevelData>(ParseLevel(world.getLevel("Level_" + std::to_string(i)))));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        TraceLog(LOG_WARNING, "LEVEL: Failed to load LDtk project %s: %s", path.c_str(), e.what());
+        levels.clear();
+        return false;
+    }
+    return true;
+}
+
+// Appends a level built in memory, e.g. by the stress level generator
+void LevelProject::Add(LevelData data)
+{
+    levels.emplace_back(std::make_unique<LevelData>(std::move(data)));
+}
+
+int LevelProject::Count() const
+{
+    return static_cast<int>(levels.size());
+}
+
+const LevelData& LevelProject::Get(int index) const
+{
+    std::lock_guard<std::mutex> lock(decodeMutex);
+    auto& level = levels.at(index);
+    if (!level)
+    {
+        level = std::make_unique<LevelData>();
+        if (!decodeBinary(index, *level))
+        {
+            TraceLog(LOG_WARNING, "LEVEL: Corrupted level %i in compiled level file", index);
+        }
+    }
+    return *level;
+}
+
+LevelData LevelProject::ParseLevel(const ldtk::Level& level)
+{
+    LevelData data;
+    data.name = level.name;
+    data.size = { static_cast<float>(level.size.x), static_cast<float>(level.size.y) };
+    if (level.hasBgImage())
+    {
+        data.background = level.getBgImage().path.filename();
+    }
+
+    auto& layers = level.allLayers();
+    auto begin = std::make_reverse_iterator(layers.end());
+    auto end = std::make_reverse_iterator(layers.begin());
+    for (; begin != end; begin++)
+    {
+        auto& layer = *begin;
+        if (!layer.hasTileset())
+        {
+            continue;
+        }
+        TileLayerData tileLayer;
+        tileLayer.tileset = layer.getTileset().path;
+        auto tileSize = float(layer.getTileset().tile_size);
+        tileLayer.tiles.reserve(layer.allTiles().size());
+        for (auto&& tile : layer.allTiles())
+        {
+            auto sourcePos = tile.getTextureRect();
+            tileLayer.tiles.push_back(TileDraw {
+                Rectangle {
+                    float(sourcePos.x),
+                    float(sourcePos.y),
+                    tile.flipX ? -tileSize : tileSize,
+                    tile.flipY ? -tileSize : tileSize,
+                },
+                Vector2 { (float)tile.getPosition().x, (float)tile.getPosition().y }
+            });
+        }
+        data.tileLayers.emplace_back(std::move(tileLayer));
+    }
+
+    for (auto& layer : layers)
+    {
+        if ((layer.getType() != ldtk::LayerType::IntGrid) || (layer.getName() != "Collisions"))
+        {
+            continue;
+        }
+        auto grid = layer.getGridSize();
+        std::vector<uint8_t> solid(static_cast<size_t>(grid.x)*grid.y, 0);
+        for (int y = 0; y < grid.y; y++)
+        {
+            for (int x = 0; x < grid.x; x++)
+            {
+                solid[static_cast<size_t>(y)*grid.x + x] = (layer.getIntGridVal(x, y).value > 0) ? 1 : 0;
+            }
+        }
+        // Total px offset of the layer (layer offset plus its definition's), as LDtk draws it
+        auto offset = layer.getOffset();
+        auto merged = MergeSolidCells(solid, grid.x, grid.y, float(layer.getCellSize()), Vector2 { float(offset.x), float(offset.y) });
+        data.terrain.insert(data.terrain.end(), merged.begin(), merged.end());
+    }
+
+    for (auto&& entity : level.getLayer("Entities").allEntities())
+    {
+        if (entity.getName() == "Car")
+        {
+            data.hasCar = true;
+            data.carPosition = { static_cast<float>(entity.getPosition().x), static_cast<float>(entity.getPosition().y) };
+        }
+        else if (entity.getName() == "Static")
+        {
+            data.statics.push_back(entityRect(entity));
+        }
+        else if (entity.getName() == "Node")
+        {
+            data.nodes.push_back(entityRect(entity));
+        }
+        else if (entity.getName() == "Passed")
+        {
+            data.passed = entityRect(entity);
+        }
+        else if (entity.getName() == "Lose")
+        {
+            data.lose = entityRect(entity);
+        }
+    }
+    return data;
+}
@@ -0,0 +1,68 @@
+#include "level_preloader.h"
+
+#include <chrono>
+#include "background_worker.h"
+#include "job_system.h"
+#include "profiler.h"
+#include "resource_pack.h"
+
+using namespace scene;
+
+LevelPreloader::~LevelPreloader()
+{
+    Cancel();
+}
+
+void LevelPreloader::Start(const LevelProject& project, int index, std::vector<std::string> imagePaths, core::JobSystem* jobs, core::BackgroundWorker* worker)
+{
+    Cancel();
+    pending = worker->Submit([&project, index, imagePaths = std::move(imagePaths), jobs]() mutable {
+        return prepare(project, index, std::move(imagePaths), jobs);
+    });
+    this->index = index;
+}
+
+void LevelPreloader::Cancel()
+{
+    if (!pending.valid())
+    {
+        return;
+    }
+    PreparedLevel prepared = Take();
+    for (auto& decoded : prepared.images)
+    {
+        UnloadImage(decoded.image);
+    }
+}
+
+bool LevelPreloader::IsReady() const
+{
+    return pending.valid() && pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+PreparedLevel LevelPreloader::Take()
+{
+    index = -1;
+    if (!pending.valid())
+    {
+        return { };
+    }
+    return pending.get();
+}
+
+PreparedLevel LevelPreloader::prepare(const LevelProject& project, int index, std::vector<std::string> imagePaths, core::JobSystem* jobs)
+{
+    PROFILE_SCOPE("LevelPreloader::prepare");
+    PreparedLevel prepared;
+    prepared.index = index;
+    prepared.data = &project.Get(index);
+    auto* pack = core::ResourcePack::getInstance();
+    for (auto& path : imagePaths)
+    {
+        prepared.images.push_back(DecodedImage { path, pack->LoadImage(path) });
+    }
+    prepared.level = std::make_unique<Level>();
+    prepared.level->SetJobSystem(jobs);
+    prepared.level->Build(*prepared.data);
+    return prepared;
+}
@@ -1,5 +1,6 @@
 #include "raylib.h"
 #include "core.h"
+#include "trace_recorder.h"
 
 #if defined(PLATFORM_WEB)
     #define CUSTOM_MODAL_DIALOGS            // Force custom modal dialogs usage
@@ -24,11 +25,14 @@
 static void UpdateDrawFrame(void);      // Update and Draw one frame
 
 
-int main(void)
+int main(int argc, char** argv)
 {
 #if !defined(_DEBUG)
     SetTraceLogLevel(LOG_NONE);
 #endif
+#if defined(NEXTJAM_PROFILER)
+    core::TraceRecorder::Configure(argc, argv);
+#endif
     
     core::Core::getInstance()->Init();
 
@@ -0,0 +1,108 @@
+#include "mapped_file.h"
+
+#include <fstream>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #define NOGDI
+    #define NOUSER
+    #include <windows.h>
+#elif !defined(PLATFORM_WEB)
+    #define MAPPED_FILE_POSIX
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace core;
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER fileSize = {};
+        HANDLE mapping = nullptr;
+        if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart > 0))
+        {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        }
+        void* view = mapping? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (view)
+        {
+            fileHandle = file;
+            mappingHandle = mapping;
+            data = static_cast<const unsigned char*>(view);
+            size = static_cast<size_t>(fileSize.QuadPart);
+            mapped = true;
+            return true;
+        }
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+    }
+#elif defined(MAPPED_FILE_POSIX)
+    int file = open(path.c_str(), O_RDONLY);
+    if (file >= 0)
+    {
+        struct stat info = {};
+        void* view = MAP_FAILED;
+        if ((fstat(file, &info) == 0) && (info.st_size > 0))
+        {
+            view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        }
+        close(file);
+        if (view != MAP_FAILED)
+        {
+            data = static_cast<const unsigned char*>(view);
+            size = static_cast<size_t>(info.st_size);
+            mapped = true;
+            return true;
+        }
+    }
+#endif
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream)
+    {
+        return false;
+    }
+    buffer.resize(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0);
+    if (buffer.empty() || !stream.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+    {
+        buffer.clear();
+        return false;
+    }
+    data = buffer.data();
+    size = buffer.size();
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (mapped)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(data);
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+#elif defined(MAPPED_FILE_POSIX)
+        munmap(const_cast<unsigned char*>(data), size);
+#endif
+    }
+    buffer.clear();
+    buffer.shrink_to_fit();
+    data = nullptr;
+    size = 0;
+    mapped = false;
+}
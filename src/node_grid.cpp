@@ -0,0 +1,101 @@
+#include "node_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace scene;
+
+void NodeGrid::Clear()
+{
+    rects.clear();
+    cellStart.clear();
+    cellItems.clear();
+    columns = 0;
+    rows = 0;
+}
+
+void NodeGrid::Build(const std::vector<Rectangle>& items)
+{
+    Clear();
+    if (items.empty())
+    {
+        return;
+    }
+    rects = items;
+
+    Vector2 min = { rects[0].x, rects[0].y };
+    Vector2 max = min;
+    for (auto& rect : rects)
+    {
+        min.x = std::min(min.x, rect.x);
+        min.y = std::min(min.y, rect.y);
+        max.x = std::max(max.x, rect.x + rect.width);
+        max.y = std::max(max.y, rect.y + rect.height);
+    }
+    origin = min;
+    columns = static_cast<int>((max.x - min.x)/cellSize) + 1;
+    rows = static_cast<int>((max.y - min.y)/cellSize) + 1;
+
+    auto cellRange = [this](const Rectangle& rect, int& x0, int& y0, int& x1, int& y1) {
+        x0 = std::clamp(static_cast<int>((rect.x - origin.x)/cellSize), 0, columns - 1);
+        y0 = std::clamp(static_cast<int>((rect.y - origin.y)/cellSize), 0, rows - 1);
+        x1 = std::clamp(static_cast<int>((rect.x + rect.width - origin.x)/cellSize), 0, columns - 1);
+        y1 = std::clamp(static_cast<int>((rect.y + rect.height - origin.y)/cellSize), 0, rows - 1);
+    };
+
+    // Counting pass then fill, so every cell is a contiguous run of item indices in
+    // ascending order
+    cellStart.assign(static_cast<size_t>(columns)*rows + 1, 0);
+    int x0, y0, x1, y1;
+    for (auto& rect : rects)
+    {
+        cellRange(rect, x0, y0, x1, y1);
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                cellStart[cellIndex(x, y) + 1]++;
+            }
+        }
+    }
+    for (size_t i = 1; i < cellStart.size(); i++)
+    {
+        cellStart[i] += cellStart[i - 1];
+    }
+    cellItems.resize(cellStart.back());
+    std::vector<uint32_t> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (uint32_t item = 0; item < rects.size(); item++)
+    {
+        cellRange(rects[item], x0, y0, x1, y1);
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                cellItems[cursor[cellIndex(x, y)]++] = item;
+            }
+        }
+    }
+}
+
+int NodeGrid::Query(Vector2 point) const
+{
+    if (rects.empty())
+    {
+        return -1;
+    }
+    auto x = static_cast<int>(std::floor((point.x - origin.x)/cellSize));
+    auto y = static_cast<int>(std::floor((point.y - origin.y)/cellSize));
+    if ((x < 0) || (y < 0) || (x >= columns) || (y >= rows))
+    {
+        return -1;
+    }
+    int cell = cellIndex(x, y);
+    for (uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; i++)
+    {
+        if (CheckCollisionPointRec(point, rects[cellItems[i]]))
+        {
+            return static_cast<int>(cellItems[i]);
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,278 @@
+#include "profiler.h"
+
+#if defined(NEXTJAM_PROFILER)
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include "box2d/box2d.h"
+#include "trace_recorder.h"
+
+using namespace core;
+
+namespace
+{
+    thread_local bool profiledThread = false;
+    std::mutex registryMutex;
+
+    struct WorldSeries
+    {
+        int step = Profiler::RegisterSeries("b2 step");
+        int pairs = Profiler::RegisterSeries("b2 pairs");
+        int collide = Profiler::RegisterSeries("b2 collide");
+        int solve = Profiler::RegisterSeries("b2 solve");
+        int broadphase = Profiler::RegisterSeries("b2 broadphase");
+        int continuous = Profiler::RegisterSeries("b2 continuous");
+        int bodies = Profiler::RegisterSeries("b2 bodies", false);
+        int contacts = Profiler::RegisterSeries("b2 contacts", false);
+        int joints = Profiler::RegisterSeries("b2 joints", false);
+        int islands = Profiler::RegisterSeries("b2 islands", false);
+        int awake = Profiler::RegisterSeries("b2 awake bodies", false);
+    };
+}
+
+Profiler* Profiler::getInstance()
+{
+    if (!instance)
+    {
+        instance = new Profiler();
+    }
+    return instance;
+}
+
+void Profiler::cleanup()
+{
+    if (!instance)
+    {
+        return;
+    }
+#if !defined(PLATFORM_WEB)
+    const char* path = std::getenv("NEXTJAM_PROFILE_CSV");
+    if (path || instance->overlayUsed)
+    {
+        instance->WriteCsv(OutputPath(path ? path : "profile.csv"));
+    }
+#endif
+    delete instance;
+    instance = nullptr;
+}
+
+std::string Profiler::OutputPath(const std::string& path)
+{
+    bool absolute = !path.empty() && ((path[0] == '/') || (path[0] == '\\') || ((path.size() > 1) && (path[1] == ':')));
+    return absolute ? path : std::string(GetApplicationDirectory()) + path;
+}
+
+std::vector<Profiler::SeriesInfo>& Profiler::registry()
+{
+    static std::vector<SeriesInfo> names = { { "frame time", true } };
+    return names;
+}
+
+int Profiler::RegisterSeries(const char* name, bool isTime)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto& names = registry();
+    for (int i = 0; i < static_cast<int>(names.size()); i++)
+    {
+        if (names[i].name == name)
+        {
+            return i;
+        }
+    }
+    names.push_back(SeriesInfo { name, isTime });
+    return static_cast<int>(names.size()) - 1;
+}
+
+bool Profiler::isRecording() const
+{
+    return profiledThread;
+}
+
+void Profiler::BeginFrame(int level)
+{
+    profiledThread = true;
+    currentLevel = level;
+    frameStart = std::chrono::steady_clock::now();
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        count = registry().size();
+    }
+    if (series.size() < count)
+    {
+        series.resize(count);
+    }
+    for (auto& entry : series)
+    {
+        entry.current = 0.0;
+    }
+}
+
+void Profiler::AddSample(int index, double value)
+{
+    if (!isRecording())
+    {
+        return;
+    }
+    if (index >= static_cast<int>(series.size()))
+    {
+        series.resize(index + 1);
+    }
+    series[index].current += value;
+}
+
+void Profiler::SetValue(int index, double value)
+{
+    if (!isRecording())
+    {
+        return;
+    }
+    if (index >= static_cast<int>(series.size()))
+    {
+        series.resize(index + 1);
+    }
+    series[index].current = value;
+}
+
+void Profiler::EndFrame()
+{
+    auto frameEnd = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> frame = frameEnd - frameStart;
+    series[0].current = frame.count();
+    if (TraceRecorder::IsEnabled())
+    {
+        TraceRecorder::Record("Frame", frameStart, frameEnd);
+        TraceRecorder::OnFrameEnd(frame.count());
+    }
+
+    FrameRecord record { frameIndex++, currentLevel, { } };
+    record.values.reserve(series.size());
+    for (auto& entry : series)
+    {
+        if (entry.window.empty())
+        {
+            entry.window.resize(windowFrames);
+        }
+        entry.window[entry.head] = static_cast<float>(entry.current);
+        entry.head = (entry.head + 1) % windowFrames;
+        entry.count = std::min(entry.count + 1, windowFrames);
+        record.values.push_back(static_cast<float>(entry.current));
+    }
+    history.emplace_back(std::move(record));
+    if (static_cast<int>(history.size()) > historyFrames)
+    {
+        history.pop_front();
+    }
+}
+
+void Profiler::RecordWorld(b2WorldId worldId)
+{
+    if (!isRecording())
+    {
+        return;
+    }
+    static const WorldSeries ids;
+    b2Profile profile = b2World_GetProfile(worldId);
+    AddSample(ids.step, profile.step);
+    AddSample(ids.pairs, profile.pairs);
+    AddSample(ids.collide, profile.collide);
+    AddSample(ids.solve, profile.solve);
+    AddSample(ids.broadphase, profile.broadphase);
+    AddSample(ids.continuous, profile.continuous);
+    b2Counters counters = b2World_GetCounters(worldId);
+    SetValue(ids.bodies, counters.bodyCount);
+    SetValue(ids.contacts, counters.contactCount);
+    SetValue(ids.joints, counters.jointCount);
+    SetValue(ids.islands, counters.islandCount);
+    // Only awake bodies report a move event
+    SetValue(ids.awake, b2World_GetBodyEvents(worldId).moveCount);
+}
+
+void Profiler::DrawOverlay(int x, int y) const
+{
+    if (!overlayVisible)
+    {
+        return;
+    }
+    constexpr int fontSize = 10;
+    constexpr int lineHeight = 12;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto& names = registry();
+    int lines = static_cast<int>(std::min(names.size(), series.size())) + 1;
+    DrawRectangle(x, y, 330, lines * lineHeight + 8, Fade(BLACK, 0.75f));
+    DrawText(TextFormat("%-22s %8s %8s %8s", "last 240 frames", "min", "avg", "p99"), x + 4, y + 4, fontSize, YELLOW);
+    std::vector<float> sorted;
+    for (int i = 0; i < lines - 1; i++)
+    {
+        const Series& entry = series[i];
+        if (entry.count == 0)
+        {
+            continue;
+        }
+        sorted.assign(entry.window.begin(), entry.window.begin() + entry.count);
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (float value : sorted)
+        {
+            sum += value;
+        }
+        float p99 = sorted[static_cast<size_t>(std::ceil(0.99 * sorted.size())) - 1];
+        const char* format = names[i].isTime ? "%-22s %8.3f %8.3f %8.3f" : "%-22s %8.0f %8.0f %8.0f";
+        DrawText(TextFormat(format, names[i].name.c_str(), sorted.front(), sum / sorted.size(), p99),
+            x + 4, y + 4 + (i + 1) * lineHeight, fontSize, RAYWHITE);
+    }
+}
+
+bool Profiler::WriteCsv(const std::string& path) const
+{
+    if (history.empty())
+    {
+        return false;
+    }
+    std::ofstream stream(path, std::ios::trunc);
+    if (!stream)
+    {
+        TraceLog(LOG_WARNING, "PROFILER: Could not write %s", path.c_str());
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto& names = registry();
+    stream << "frame,level";
+    for (auto& info : names)
+    {
+        stream << ',' << info.name;
+    }
+    stream << '\n';
+    for (auto& record : history)
+    {
+        stream << record.frame << ',' << record.level;
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            stream << ',';
+            if (i < record.values.size())
+            {
+                stream << record.values[i];
+            }
+        }
+        stream << '\n';
+    }
+    TraceLog(LOG_INFO, "PROFILER: Wrote %i frames to %s", static_cast<int>(history.size()), path.c_str());
+    return static_cast<bool>(stream);
+}
+
+ProfileScope::~ProfileScope()
+{
+    auto end = std::chrono::steady_clock::now();
+    if (profiledThread)
+    {
+        std::chrono::duration<double, std::milli> elapsed = end - start;
+        Profiler::getInstance()->AddSample(series, elapsed.count());
+    }
+    if (TraceRecorder::IsEnabled())
+    {
+        TraceRecorder::Record(name, start, end);
+    }
+}
+#endif
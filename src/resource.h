@@ -1,5 +1,6 @@
 #pragma once
 #include "raylib.h"
+#include "audio_system.h"
 #include <string>
 #include <array>
 
@@ -69,38 +70,14 @@ inline size_t AddEffect(const char* name, float volume = 1.0f);
 
 struct Resources
 {
-    static void LoadTextures()
-    {
-        using std::string_literals::operator""s;
-        std::string dir = GetWorkingDirectory();
-        car = LoadTexture((dir + "/car.png").c_str());
-        wheel = LoadTexture((dir + "/wheel.png").c_str());
-    }
-
-    static void LoadFonts()
-    {
-        std::string dir = GetWorkingDirectory();
-        baseFont = LoadFontEx((dir + "/SCHABO-Condensed.otf").c_str(), 64, 0, 250);
-    }
-
-    static void LoadMusic()
-    {
-        std::string dir = GetWorkingDirectory();
-        music = LoadMusicStream((dir + "/main.mp3").c_str());
-        effect = LoadSound((dir + "/effect1.mp3").c_str());
-        effect2 = LoadSound((dir + "/effect2.mp3").c_str());
-        effect3 = LoadSound((dir + "/effect3.mp3").c_str());
-        effect4 = LoadSound((dir + "/effect4.mp3").c_str());
-        effectCar = LoadMusicStream((dir + "/car.wav").c_str());
-    }
-
+    // Filled in by core::StartupLoader
     inline static Texture car;
     inline static Texture wheel;
     inline static Font baseFont;
-    inline static Music music;
-    inline static Sound effect;
-    inline static Sound effect2;
-    inline static Sound effect3;
-    inline static Sound effect4;
-    inline static Music effectCar;
+    inline static core::StreamId music = -1;
+    inline static core::EffectId effect = -1;
+    inline static core::EffectId effect2 = -1;
+    inline static core::EffectId effect3 = -1;
+    inline static core::EffectId effect4 = -1;
+    inline static core::StreamId effectCar = -1;
 };
@@ -0,0 +1,70 @@
+#include "resource_cache.h"
+
+#include "resource_pack.h"
+
+using namespace core;
+
+ResourceCache* ResourceCache::getInstance()
+{
+    if (!instance)
+    {
+        instance = new ResourceCache();
+    }
+    return instance;
+}
+
+void ResourceCache::cleanup()
+{
+    delete instance;
+    instance = nullptr;
+}
+
+ResourceCache::~ResourceCache()
+{
+    for (auto& [path, entry] : textures)
+    {
+        UnloadTexture(entry.texture);
+    }
+}
+
+Texture2D ResourceCache::AcquireTexture(const std::string& path)
+{
+    auto found = textures.find(path);
+    if (found != textures.end())
+    {
+        found->second.refCount++;
+        return found->second.texture;
+    }
+    Image image = ResourcePack::getInstance()->LoadImage(path);
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    textures.emplace(path, TextureEntry { texture, 1 });
+    return texture;
+}
+
+Texture2D ResourceCache::AcquireTexture(const std::string& path, Image image)
+{
+    auto found = textures.find(path);
+    if (found != textures.end())
+    {
+        found->second.refCount++;
+        return found->second.texture;
+    }
+    Texture2D texture = LoadTextureFromImage(image);
+    textures.emplace(path, TextureEntry { texture, 1 });
+    return texture;
+}
+
+void ResourceCache::ReleaseTexture(const std::string& path)
+{
+    auto found = textures.find(path);
+    if (found == textures.end())
+    {
+        return;
+    }
+    if (--found->second.refCount <= 0)
+    {
+        UnloadTexture(found->second.texture);
+        textures.erase(found);
+    }
+}
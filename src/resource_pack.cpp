@@ -0,0 +1,281 @@
+#include "resource_pack.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+using namespace core;
+
+//----------------------------------------------------------------------------------
+// resources.pak layout (little endian)
+//
+//   PackHeader
+//   PackRecord[entryCount]      name range in the name table, data offset from the file
+//                               start, stored and original size, flags
+//   name table                  entry names back to back, no terminators
+//   entry data                  every entry aligned to 16 bytes; stored entries are used
+//                               in place, deflated ones are inflated on read
+//----------------------------------------------------------------------------------
+
+namespace
+{
+    constexpr char packMagic[4] = { 'N', 'J', 'P', 'K' };
+    constexpr uint32_t packVersion = 1;
+    constexpr uint32_t entryDeflated = 1;
+    constexpr uint32_t entryAlignment = 16;
+
+    struct PackHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t nameTableSize;
+    };
+
+    struct PackRecord
+    {
+        uint32_t nameOffset;
+        uint32_t nameSize;
+        uint32_t offset;
+        uint32_t storedSize;
+        uint32_t size;
+        uint32_t flags;
+    };
+
+    uint32_t alignUp(uint32_t value)
+    {
+        return (value + entryAlignment - 1) & ~(entryAlignment - 1);
+    }
+}
+
+AssetData AssetData::Adopt(unsigned char* buffer, int size)
+{
+    AssetData asset(buffer, size);
+    asset.owned = buffer;
+    return asset;
+}
+
+AssetData::~AssetData()
+{
+    if (owned)
+    {
+        MemFree(owned);
+    }
+}
+
+AssetData::AssetData(AssetData&& other) noexcept
+    : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)), owned(std::exchange(other.owned, nullptr))
+{
+}
+
+AssetData& AssetData::operator=(AssetData&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (owned)
+        {
+            MemFree(owned);
+        }
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        owned = std::exchange(other.owned, nullptr);
+    }
+    return *this;
+}
+
+ResourcePack* ResourcePack::getInstance()
+{
+    if (!instance)
+    {
+        instance = new ResourcePack();
+    }
+    return instance;
+}
+
+void ResourcePack::cleanup()
+{
+    delete instance;
+    instance = nullptr;
+}
+
+bool ResourcePack::OpenDefault()
+{
+    const char* loose = getenv("NEXTJAM_LOOSE_RESOURCES");
+    if (loose && (strcmp(loose, "0") != 0))
+    {
+        return false;
+    }
+    std::string appDir = GetApplicationDirectory();
+    for (const std::string& path : { appDir + "resources.pak", appDir + "../resources.pak", std::string("resources.pak") })
+    {
+        if (FileExists(path.c_str()) && Open(path))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ResourcePack::Open(const std::string& path)
+{
+    entries.clear();
+    if (!file.Open(path))
+    {
+        return false;
+    }
+    const unsigned char* data = file.Data();
+    size_t size = file.Size();
+    PackHeader header = {};
+    if (size >= sizeof(header))
+    {
+        std::memcpy(&header, data, sizeof(header));
+    }
+    size_t tableEnd = sizeof(header) + size_t(header.entryCount) * sizeof(PackRecord);
+    if ((size < sizeof(header)) || (std::memcmp(header.magic, packMagic, sizeof(packMagic)) != 0) || (header.version != packVersion)
+        || (tableEnd > size) || (header.nameTableSize > size - tableEnd))
+    {
+        TraceLog(LOG_WARNING, "PACK: %s is not a resource pack of version %u", path.c_str(), packVersion);
+        file.Close();
+        return false;
+    }
+    const char* names = reinterpret_cast<const char*>(data + tableEnd);
+    entries.reserve(header.entryCount);
+    for (uint32_t i = 0; i < header.entryCount; i++)
+    {
+        PackRecord record = {};
+        std::memcpy(&record, data + sizeof(header) + i*sizeof(PackRecord), sizeof(record));
+        if ((record.nameOffset > header.nameTableSize) || (record.nameSize > header.nameTableSize - record.nameOffset)
+            || (record.offset > size) || (record.storedSize > size - record.offset))
+        {
+            TraceLog(LOG_WARNING, "PACK: Truncated entry table in %s", path.c_str());
+            entries.clear();
+            file.Close();
+            return false;
+        }
+        entries.emplace(std::string(names + record.nameOffset, record.nameSize),
+            Entry { record.offset, record.storedSize, record.size, record.flags });
+    }
+    // The pack stands in for the resources/ directory next to it
+    const char* packDir = GetDirectoryPath(path.c_str());
+    root = std::string((packDir && *packDir)? packDir : ".") + "/resources";
+    TraceLog(LOG_INFO, "PACK: Mapped %s, %i entries", path.c_str(), static_cast<int>(entries.size()));
+    return true;
+}
+
+const ResourcePack::Entry* ResourcePack::find(const std::string& path) const
+{
+    if (entries.empty() || (path.size() <= root.size()) || (path.compare(0, root.size(), root) != 0) || (path[root.size()] != '/'))
+    {
+        return nullptr;
+    }
+    auto found = entries.find(path.substr(root.size() + 1));
+    return (found != entries.end())? &found->second : nullptr;
+}
+
+bool ResourcePack::Contains(const std::string& path) const
+{
+    return find(path) != nullptr;
+}
+
+AssetData ResourcePack::Read(const std::string& path) const
+{
+    const Entry* entry = find(path);
+    if (!entry)
+    {
+        int size = 0;
+        unsigned char* loose = LoadFileData(path.c_str(), &size);
+        return loose? AssetData::Adopt(loose, size) : AssetData();
+    }
+    const unsigned char* stored = file.Data() + entry->offset;
+    if (!(entry->flags & entryDeflated))
+    {
+        return AssetData(stored, static_cast<int>(entry->storedSize));
+    }
+    int size = 0;
+    unsigned char* inflated = DecompressData(stored, static_cast<int>(entry->storedSize), &size);
+    if (!inflated || (size != static_cast<int>(entry->size)))
+    {
+        TraceLog(LOG_WARNING, "PACK: Cannot inflate %s", path.c_str());
+        if (inflated)
+        {
+            MemFree(inflated);
+        }
+        return AssetData();
+    }
+    return AssetData::Adopt(inflated, size);
+}
+
+Image ResourcePack::LoadImage(const std::string& path) const
+{
+    AssetData asset = Read(path);
+    return asset? LoadImageFromMemory(GetFileExtension(path.c_str()), asset.Data(), asset.Size()) : Image { };
+}
+
+Wave ResourcePack::LoadWave(const std::string& path) const
+{
+    AssetData asset = Read(path);
+    return asset? LoadWaveFromMemory(GetFileExtension(path.c_str()), asset.Data(), asset.Size()) : Wave { };
+}
+
+bool ResourcePack::Write(const std::string& path, std::vector<PackSource>& sources)
+{
+    PackHeader header = { { packMagic[0], packMagic[1], packMagic[2], packMagic[3] }, packVersion, static_cast<uint32_t>(sources.size()), 0 };
+    std::string names;
+    for (auto& source : sources)
+    {
+        names += source.name;
+    }
+    header.nameTableSize = static_cast<uint32_t>(names.size());
+
+    std::vector<PackRecord> records(sources.size());
+    std::vector<std::vector<unsigned char>> blocks(sources.size());
+    uint32_t nameOffset = 0;
+    uint32_t offset = alignUp(static_cast<uint32_t>(sizeof(header) + records.size()*sizeof(PackRecord) + names.size()));
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        PackSource& source = sources[i];
+        PackRecord& record = records[i];
+        record.nameOffset = nameOffset;
+        record.nameSize = static_cast<uint32_t>(source.name.size());
+        nameOffset += record.nameSize;
+        record.size = static_cast<uint32_t>(source.data.size());
+        blocks[i] = source.data;
+        if (source.compress && !source.data.empty())
+        {
+            int compressedSize = 0;
+            unsigned char* compressed = CompressData(source.data.data(), static_cast<int>(source.data.size()), &compressedSize);
+            if (compressed && (static_cast<size_t>(compressedSize) <= source.data.size() - source.data.size()/8))
+            {
+                blocks[i].assign(compressed, compressed + compressedSize);
+                record.flags |= entryDeflated;
+            }
+            if (compressed)
+            {
+                MemFree(compressed);
+            }
+        }
+        record.offset = offset;
+        record.storedSize = static_cast<uint32_t>(blocks[i].size());
+        source.storedSize = record.storedSize;
+        offset = alignUp(offset + record.storedSize);
+    }
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        return false;
+    }
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(records.data()), records.size()*sizeof(PackRecord));
+    stream.write(names.data(), names.size());
+    const char padding[entryAlignment] = { };
+    uint32_t written = static_cast<uint32_t>(sizeof(header) + records.size()*sizeof(PackRecord) + names.size());
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        stream.write(padding, records[i].offset - written);
+        stream.write(reinterpret_cast<const char*>(blocks[i].data()), blocks[i].size());
+        written = records[i].offset + records[i].storedSize;
+    }
+    return static_cast<bool>(stream);
+}
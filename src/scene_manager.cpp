@@ -1,14 +1,18 @@
 #include "scene_manager.h"
 
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <cassert>
-#include <LDtkLoader/Project.hpp>
-#include <LDtkLoader/World.hpp>
+#include <cstdlib>
+#include "background_worker.h"
 #include "core.h"
+#include "profiler.h"
 #include "raymath.h"
 #include "resource.h"
+#include "resource_cache.h"
+#include "resource_pack.h"
 #include "utils.h"
-#include "car.h"
 
 using namespace scene;
 using namespace std::string_literals;
@@ -31,31 +35,103 @@ SceneManager* SceneManager::getInstance()
 void SceneManager::cleanup()
 {
     delete instance;
+    instance = nullptr;
+}
+
+SceneManager::~SceneManager()
+{
+	preloader.Cancel();
+	if (spareLevel.valid()) {
+		spareLevel.wait();
+	}
+	if (!recordingPath.empty()) {
+		recording.Finish(currentLevel, activeLevel->GetStepCount(), activeLevel->ComputeChecksum());
+		if (recording.Save(recordingPath)) {
+			TraceLog(LOG_INFO, "INPUT: Recorded %i inputs to %s", static_cast<int>(recording.Events().size()), recordingPath.c_str());
+		}
+	}
+	activeLevel->Destroy();
+	auto* cache = core::ResourceCache::getInstance();
+	for (auto& path : levelTextures) {
+		cache->ReleaseTexture(path);
+	}
+	std::string dir = core::ResourcePack::getInstance()->GetRoot();
+	for (auto i = 0; i < static_cast<int>(tutorials.size()); i++) {
+		cache->ReleaseTexture(dir + "/tutorial" + std::to_string(i) + ".png"s);
+	}
+	tilemap.Unload();
+}
+
+// Thread safe, the startup loader parses the project on a worker thread
+std::unique_ptr<LevelProject> SceneManager::LoadLevelProject(const std::string& dir)
+{
+	auto project = std::make_unique<LevelProject>();
+	// NEXTJAM_LEVELS=<file.bin> plays another compiled project, e.g. generated stress levels
+	const char* levelsOverride = getenv("NEXTJAM_LEVELS");
+	if (levelsOverride && project->LoadFromBinary(levelsOverride)) {
+		return project;
+	}
+	std::string ldtkPath = dir + "/levels.ldtk"s;
+	// A packed levels.bin is used in place, the pack stays mapped for the whole run
+	std::string packedPath = dir + "/levels.bin"s;
+	auto* pack = core::ResourcePack::getInstance();
+	if (pack->Contains(packedPath)) {
+		core::AssetData packed = pack->Read(packedPath);
+		if (packed.IsMapped() && project->LoadFromMemory(packed.Data(), packed.Size(), packedPath)) {
+			return project;
+		}
+	}
+	// The build compiles it next to the executable (one up for multi-config generators),
+	// like resources.pak; one placed in the resource folder is used otherwise
+	std::string appDir = GetApplicationDirectory();
+	std::string binaryPath = packedPath;
+	for (const std::string& path : { appDir + "levels.bin", appDir + "../levels.bin" }) {
+		if (FileExists(path.c_str())) {
+			binaryPath = path;
+			break;
+		}
+	}
+	// Prefer the compiled levels unless the LDtk project was edited after the last compile
+	bool binaryIsStale = FileExists(ldtkPath.c_str()) && (GetFileModTime(ldtkPath.c_str()) > GetFileModTime(binaryPath.c_str()));
+	if (binaryIsStale || !project->LoadFromBinary(binaryPath)) {
+		project->LoadFromLdtk(ldtkPath);
+	}
+	return project;
+}
+
+void SceneManager::SetLevelProject(std::unique_ptr<LevelProject> project)
+{
+	preloader.Cancel();
+	// A spare still building reads the old project
+	if (spareLevel.valid()) {
+		spareLevel.wait();
+	}
+	spareLevel = { };
+	spareLevelIndex = -1;
+	levelProject = std::move(project);
+	maxLevels = levelProject->Count();
 }
 
 SceneManager::SceneManager()
 {
-    std::string dir = GetWorkingDirectory();
-    ldtkProject.loadFromFile((dir + "/levels.ldtk"s).c_str());
-	ldtkWorld = &ldtkProject.getWorld();
-	maxLevels = static_cast<int>(ldtkWorld->allLevels().size());
+    std::string dir = core::ResourcePack::getInstance()->GetRoot();
+	activeLevel = std::make_unique<Level>();
+	activeLevel->SetJobSystem(core::Core::getInstance()->GetJobSystem());
+	activeLevel->SetAdaptiveSubSteps(true);
+	// NEXTJAM_RECORD=<file> records every gameplay input for NextJam_headless --replay
+	if (const char* path = getenv("NEXTJAM_RECORD")) {
+		recordingPath = path;
+		recording.Begin(currentLevel);
+	}
 	tutorialPos = {
 		{ 512.0f, 204.0f },
 		{ 507.0f, 207.0f },
 		{ 700.0f, 59.0f }
 	};
 	for (auto i = 0; i < 3; i++) {
-		Texture2D texture = LoadTexture((dir + "/tutorial" + std::to_string(i) + ".png"s).c_str());
+		Texture2D texture = core::ResourceCache::getInstance()->AcquireTexture(dir + "/tutorial" + std::to_string(i) + ".png"s);
 		tutorials.emplace_back(texture);
 	}
-	createB2World();
-}
-
-void SceneManager::createB2World()
-{
-	b2WorldDef worldDef = b2DefaultWorldDef();
-	worldDef.gravity.y = 9.8f * 50;
-	worldId = b2CreateWorld(&worldDef);
 }
 
 Rectangle& SceneManager::ScreenInWorld()
@@ -65,14 +141,65 @@ Rectangle& SceneManager::ScreenInWorld()
 
 bool SceneManager::IsLevelClear()
 {
-    return state == LevelState::PASSED;
+    return activeLevel->GetState() == LevelState::PASSED;
 }
 
 void SceneManager::NextLevel()
 {
-    Reset();
-	setLevel(currentLevel + 1);
-    Load();
+	PROFILE_SCOPE("SceneManager::NextLevel");
+	int next = currentLevel + 1;
+	recordInput(InputType::ChangeLevel, next);
+	if (preloader.GetIndex() != next) {
+		preloader.Cancel();
+		Reset();
+		setLevel(next);
+		Load();
+		return;
+	}
+	PreparedLevel prepared = preloader.Take();
+	Reset();
+	setLevel(next);
+	if (tilemapLevelIndex != currentLevel) {
+		prepareTilemap(*prepared.data, prepared.images);
+	}
+	for (auto& decoded : prepared.images) {
+		UnloadImage(decoded.image);
+	}
+	activeLevel = std::move(prepared.level);
+	activeLevel->SetAdaptiveSubSteps(true);
+	prepareSpareLevel();
+}
+
+void SceneManager::preloadNextLevel()
+{
+	int next = IsLastLevel() ? 0 : currentLevel + 1;
+	const LevelData& data = levelProject->Get(next);
+	std::vector<std::string> imagePaths;
+	auto* cache = core::ResourceCache::getInstance();
+	for (auto& path : LevelTexturePaths(data, core::ResourcePack::getInstance()->GetRoot())) {
+		if (!cache->HasTexture(path)) {
+			imagePaths.emplace_back(path);
+		}
+	}
+	auto* game = core::Core::getInstance();
+	preloader.Start(*levelProject, next, std::move(imagePaths), game->GetJobSystem(), game->GetBackgroundWorker());
+}
+
+std::vector<std::string> SceneManager::LevelTexturePaths(const LevelData& data, const std::string& dir)
+{
+	std::vector<std::string> paths;
+	if (!data.background.empty()) {
+		paths.emplace_back(dir + "/"s + data.background);
+	}
+	for (auto& layer : data.tileLayers) {
+		paths.emplace_back(dir + "/"s + layer.tileset);
+	}
+	return paths;
+}
+
+int SceneManager::GetCurrentLevel() const
+{
+	return currentLevel;
 }
 
 bool scene::SceneManager::IsLastLevel()
@@ -87,8 +214,9 @@ void scene::SceneManager::setLevel(int level)
 
 void scene::SceneManager::MoveCar()
 {
-	m_car.SetSpeed(150.0f);
-	PlayMusicStream(Resources::effectCar);
+	recordInput(InputType::MoveCar);
+	activeLevel->MoveCar();
+	core::AudioSystem::getInstance()->PlayStream(Resources::effectCar);
 }
 
 void scene::SceneManager::SetTutotrialPassed()
@@ -99,194 +227,227 @@ void scene::SceneManager::SetTutotrialPassed()
 
 void SceneManager::Load()
 {
-	if (worldId) {
-		createB2World();
-	}
-	currentLdtkLevel = &ldtkWorld->getLevel("Level_" + std::to_string(currentLevel));
-
-	auto levelSize = currentLdtkLevel->size;
-	auto renderTexture = LoadRenderTexture(levelSize.x, levelSize.y);
-
-	BeginTextureMode(renderTexture);
-
-	std::string dir = GetWorkingDirectory();
-	if (currentLdtkLevel->hasBgImage())
-	{
-		auto backgroundPath = currentLdtkLevel->getBgImage();
-		auto backgroundTexture = LoadTexture((dir + "/"s + backgroundPath.path.filename()).c_str());
-		SetTextureFilter(backgroundTexture, TEXTURE_FILTER_TRILINEAR);
-
-		DrawTextureV(backgroundTexture, { }, WHITE);
-	}
-
-	auto& layers = currentLdtkLevel->allLayers();
-	auto begin = std::make_reverse_iterator(layers.end());
-	auto end = std::make_reverse_iterator(layers.begin());
-	for (; begin != end; begin++)
-	{
-		auto& layer = *begin;
-		if (layer.hasTileset())
-		{
-			currentTilesetTexture = LoadTexture((dir + "/"s + layer.getTileset().path).c_str());
-			for (auto&& tile : layer.allTiles())
-			{
-				auto source_pos = tile.getTextureRect();
-				auto tile_size = float(layer.getTileset().tile_size);
-
-				Rectangle source_rect = {
-					float(source_pos.x),
-					float(source_pos.y),
-					tile.flipX ? -tile_size : tile_size,
-					tile.flipY ? -tile_size : tile_size,
-				};
-
-				Vector2 target_pos = {
-					(float)tile.getPosition().x,
-					(float)tile.getPosition().y,
-				};
-
-				DrawTextureRec(currentTilesetTexture, source_rect, target_pos, WHITE);
-			}
-		}
+	PROFILE_SCOPE("SceneManager::Load");
+	const LevelData& data = levelProject->Get(currentLevel);
+	if (tilemapLevelIndex != currentLevel) {
+		prepareTilemap(data, { });
 	}
+	activeLevel->Build(data);
+	prepareSpareLevel();
+}
 
-	EndTextureMode();
-	renderedLevelTexture = renderTexture.texture;
-
-	for (auto&& entity : currentLdtkLevel->getLayer("Entities").allEntities())
-	{
-
-		if (entity.getName() == "Car") {
-			float m_speed = 35.0f;
-			float m_torque = 90000.0f;
-			float m_hertz = 25.0f;
-			float m_dampingRatio = 0.7f;
-			m_car.Spawn(worldId.value(), { static_cast<float>(entity.getPosition().x),
-				static_cast<float>(entity.getPosition().y) }, 10.0f, m_hertz, m_dampingRatio, m_torque);
+// Builds the spare on the background worker, reusing the given level (or the previous
+// spare, once built) so the old world is destroyed there too. Built from the same data in
+// the same order, the spare steps exactly like a level rebuilt in place, which keeps
+// replays valid. A build still running is never waited for: one for this level is kept,
+// one for another level is dropped and its result freed on the worker. No threads on
+// the web build: there is no spare and a restart rebuilds in place at the same cost.
+void SceneManager::prepareSpareLevel(std::unique_ptr<Level> level)
+{
+#if !defined(PLATFORM_WEB)
+	std::unique_ptr<Level> unused;
+	if (spareLevel.valid()) {
+		if (!level && (spareLevelIndex == currentLevel)) {
+			return;
 		}
-		else if (entity.getName() == "Static") {
-			auto b2width = entity.getSize().x / 2.0f;
-			auto b2height = entity.getSize().y / 2.0f;
-
-			auto centerX = entity.getPosition().x + b2width;
-			auto centerY = entity.getPosition().y + b2height;
-
-			b2BodyDef bodyDef = b2DefaultBodyDef();
-			bodyDef.position = { centerX, centerY };
-
-			b2BodyId body = b2CreateBody(worldId.value(), &bodyDef);
-
-			b2BodyId groundId = b2CreateBody(worldId.value(), &bodyDef);
-
-			b2Polygon groundBox = b2MakeBox(b2width, b2height);
-			b2ShapeDef groundShapeDef = b2DefaultShapeDef();
-			b2CreatePolygonShape(groundId, &groundShapeDef, &groundBox);
-			Entity localEntity;
-			localEntity.pos = { static_cast<float>(entity.getPosition().x), static_cast<float>(entity.getPosition().y) };
-			localEntity.bodyId = body;
-			localEntity.extent = { static_cast<float>(entity.getSize().x), static_cast<float>(entity.getSize().y) };
-
-			groundEntities.emplace_back(localEntity);
+		if (spareLevel.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			unused = spareLevel.get();
 		}
-		else if (entity.getName() == "Node") {
-			auto b2width = entity.getSize().x / 2.0f;
-			auto b2height = entity.getSize().y / 2.0f;
-
-			auto centerX = entity.getPosition().x + b2width;
-			auto centerY = entity.getPosition().y + b2height;
-
-			b2BodyDef bodyDef = b2DefaultBodyDef();
-			bodyDef.position = { centerX, centerY };
+		spareLevel = { };
+	}
+	if (!level) {
+		level = unused ? std::move(unused) : std::make_unique<Level>();
+	}
+	const LevelData& data = levelProject->Get(currentLevel);
+	auto* game = core::Core::getInstance();
+	core::JobSystem* jobs = game->GetJobSystem();
+	spareLevel = game->GetBackgroundWorker()->Submit([&data, jobs, spare = std::move(level), unused = std::move(unused)]() mutable {
+		PROFILE_SCOPE("SceneManager::prepareSpareLevel");
+		unused.reset();
+		spare->SetJobSystem(jobs);
+		spare->Build(data);
+		spare->SetAdaptiveSubSteps(true);
+		return std::move(spare);
+	});
+	spareLevelIndex = currentLevel;
+#endif
+}
 
-			b2BodyId body = b2CreateBody(worldId.value(), &bodyDef);
+void SceneManager::prepareTilemap(const LevelData& data, const std::vector<DecodedImage>& images)
+{
+	// Acquire the new level's textures before releasing the old ones so shared
+	// tilesets stay uploaded across level changes
+	std::vector<std::string> textures = LevelTexturePaths(data, core::ResourcePack::getInstance()->GetRoot());
+	auto* cache = core::ResourceCache::getInstance();
+	std::vector<Texture2D> uploaded;
+	for (auto& path : textures) {
+		auto decoded = std::find_if(images.begin(), images.end(), [&path](const DecodedImage& image) {
+			return image.path == path;
+		});
+		uploaded.emplace_back(decoded != images.end() ? cache->AcquireTexture(path, decoded->image) : cache->AcquireTexture(path));
+	}
+	for (auto& path : levelTextures) {
+		cache->ReleaseTexture(path);
+	}
+	levelTextures = std::move(textures);
 
-			b2BodyId groundId = b2CreateBody(worldId.value(), &bodyDef);
+	Texture2D background = { };
+	auto tilesets = uploaded.begin();
+	if (!data.background.empty()) {
+		background = *tilesets++;
+		SetTextureFilter(background, TEXTURE_FILTER_TRILINEAR);
+	}
+	tilemap.Build(data, background, std::vector<Texture2D>(tilesets, uploaded.end()));
+	tilemapLevelIndex = currentLevel;
+	levelSize = data.size;
+}
 
-			b2Polygon groundBox = b2MakeBox(b2width, b2height);
-			b2ShapeDef groundShapeDef = b2DefaultShapeDef();
-			b2CreatePolygonShape(groundId, &groundShapeDef, &groundBox);
-			Entity localEntity;
-			localEntity.pos = { static_cast<float>(entity.getPosition().x), static_cast<float>(entity.getPosition().y) };
-			localEntity.bodyId = body;
-			localEntity.extent = { static_cast<float>(entity.getSize().x), static_cast<float>(entity.getSize().y) };
+// Runs before the game target is bound: chunks are baked into their own render textures
+void SceneManager::PrepareDraw()
+{
+	PROFILE_SCOPE("SceneManager::PrepareDraw");
+	updateCamera();
+	tilemap.Update(screenInWorld);
+}
 
-			nodeEntities.emplace_back(localEntity);
-		}
-		else if (entity.getName() == "Passed") {
-			passedEntity.pos = { static_cast<float>(entity.getPosition().x), static_cast<float>(entity.getPosition().y) };
-			passedEntity.extent = { static_cast<float>(entity.getSize().x), static_cast<float>(entity.getSize().y) };
-		}
-		else if (entity.getName() == "Lose") {
-			loseEntity.pos = { static_cast<float>(entity.getPosition().x), static_cast<float>(entity.getPosition().y) };
-			loseEntity.extent = { static_cast<float>(entity.getSize().x), static_cast<float>(entity.getSize().y) };
-		}
+// Follows the car on levels bigger than the screen, clamped to the level bounds
+void SceneManager::updateCamera()
+{
+	Vector2 screen = { (float)core::gameScreenWidth, (float)core::gameScreenHeight };
+	Vector2 focus = Vector2Scale(screen, 0.5f);
+	if (activeLevel->GetCar().IsSpawned()) {
+		focus = activeLevel->GetCar().GetPosition();
 	}
-	state = LevelState::PLAYING;
+	worldCamera.offset = {};
+	worldCamera.target = {
+		Clamp(focus.x - screen.x / 2.0f, 0.0f, fmaxf(0.0f, levelSize.x - screen.x)),
+		Clamp(focus.y - screen.y / 2.0f, 0.0f, fmaxf(0.0f, levelSize.y - screen.y))
+	};
+	worldCamera.zoom = 1.0f;
+	Vector2 screenOriginInWorld = GetScreenToWorld2D(Vector2Zero(), worldCamera);
+	Vector2 screenEdgeInWorld = GetScreenToWorld2D(screen, worldCamera);
+	screenInWorld = Rectangle{ screenOriginInWorld.x, screenOriginInWorld.y, screenEdgeInWorld.x - screenOriginInWorld.x, screenEdgeInWorld.y - screenOriginInWorld.y };
 }
 
 void SceneManager::Update()
 {
-	UpdateMusicStream(Resources::effectCar);
+	PROFILE_SCOPE("SceneManager::Update");
     float deltaTime = GetFrameTime();
     seconds += deltaTime;
-	if (worldId) {
-		b2World_Step(worldId.value(), 0.016f, 4);
+	LevelState previousState = activeLevel->GetState();
+	int step = activeLevel->GetStepCount();
+	int subSteps = activeLevel->GetSubStepCount();
+	activeLevel->Update(deltaTime);
+	// The controller picks the count before the frame's first step
+	if (!recordingPath.empty() && (activeLevel->GetSubStepCount() != subSteps)) {
+		recording.Record(step, InputType::SubSteps, activeLevel->GetSubStepCount());
+	}
+	if (activeLevel->GetState() != previousState) {
+		onLevelStateChanged(activeLevel->GetState());
 	}
+	handleEditKeys();
 	checkCollisions();
 }
 
+// Ctrl+Z undoes the last beam placed or removed, Ctrl+Y or Ctrl+Shift+Z redoes it
+void SceneManager::handleEditKeys()
+{
+	if (!IsKeyDown(KEY_LEFT_CONTROL) && !IsKeyDown(KEY_RIGHT_CONTROL)) {
+		return;
+	}
+	bool shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+	if (IsKeyPressed(KEY_Y) || (IsKeyPressed(KEY_Z) && shift)) {
+		if (editHistory.Redo(*activeLevel)) {
+			recordInput(InputType::Redo);
+		}
+	}
+	else if (IsKeyPressed(KEY_Z)) {
+		if (editHistory.Undo(*activeLevel)) {
+			recordInput(InputType::Undo);
+		}
+	}
+}
+
+// Inputs are tagged with the steps the level has taken, they always land between two steps
+void SceneManager::recordInput(InputType type, int a, int b)
+{
+	if (!recordingPath.empty()) {
+		recording.Record(activeLevel->GetStepCount(), type, a, b);
+	}
+}
+
+void scene::SceneManager::onLevelStateChanged(LevelState state)
+{
+	if (state == LevelState::PASSED) {
+		core::AudioSystem::getInstance()->StopStream(Resources::effectCar);
+		preloadNextLevel();
+	}
+	else if (state == LevelState::LOSE) {
+		core::AudioSystem::getInstance()->StopStream(Resources::effectCar);
+		core::Core::getInstance()->OnLose();
+	}
+}
+
 void scene::SceneManager::checkCollisions()
 {
 	checkNodesCollision();
-	checkCarCollision();
 }
 
 void SceneManager::checkNodesCollision()
 {
 	mousePosition = GetMousePosition();
 	float scale = MIN(core::gameScreenWidth / (float)GetScreenWidth(), core::gameScreenHeight / (float)GetScreenHeight());
-	mousePosition = Vector2Scale(mousePosition, scale);
-	if (focusNode && !checkEntityCollision(focusNode, mousePosition)) {
-		focusNode = nullptr;
-	}
-	for (auto& node : nodeEntities) {
-		if (checkEntityCollision(&node, mousePosition))
-		{
-			focusNode = &node;
-			if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-				PlaySound(Resources::effect4);
-				if (selectedNode && focusNode != selectedNode) {
-					AddJoint(selectedNode, focusNode);
-					selectedNode = nullptr;
-					focusNode = nullptr;
-					if (!tutorialPassed && tutorialStep == 1) {
-						tutorialStep = 2;
-					}
-					return;
+	mousePosition = GetScreenToWorld2D(Vector2Scale(mousePosition, scale), worldCamera);
+	if (focusNode.IsValid() && !checkEntityCollision(focusNode, mousePosition)) {
+		focusNode = { };
+	}
+	EntityHandle node = activeLevel->PickNode(mousePosition);
+	if (node.IsValid()) {
+		focusNode = node;
+		if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+			core::AudioSystem::getInstance()->PlayEffect(Resources::effect4);
+			if (selectedNode.IsValid() && focusNode != selectedNode) {
+				recordInput(InputType::AddJoint, activeLevel->Nodes().Find(selectedNode), activeLevel->Nodes().Find(focusNode));
+				editHistory.AddJoint(*activeLevel, selectedNode, focusNode);
+				selectedNode = { };
+				focusNode = { };
+				if (!tutorialPassed && tutorialStep == 1) {
+					tutorialStep = 2;
 				}
+				return;
+			}
 
-				selectedNode = &node;
-				if (selectedNode == &(*nodeEntities.begin()) && !tutorialPassed && tutorialStep == 0) {
-					tutorialStep = 1;
-				}
-				focusNode = nullptr;
+			selectedNode = node;
+			recordInput(InputType::SelectNode, activeLevel->Nodes().Find(selectedNode));
+			if (activeLevel->Nodes().Find(selectedNode) == 0 && !tutorialPassed && tutorialStep == 0) {
+				tutorialStep = 1;
 			}
-			return;
+			focusNode = { };
 		}
-
+		return;
 	}
-	if (!selectedNode) {
+	if (!selectedNode.IsValid()) {
+		// Right click on a beam removes it, undoable like a placement
+		if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
+			EntityHandle beam = activeLevel->PickBeam(mousePosition);
+			int index = activeLevel->JointBodies().Find(beam);
+			if (index >= 0) {
+				recordInput(InputType::RemoveJoint, index);
+				editHistory.RemoveJoint(*activeLevel, beam);
+			}
+		}
 	}
 	else {
 		if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
-			selectedNode = nullptr;
-			focusNode = nullptr;
+			recordInput(InputType::Cancel);
+			selectedNode = { };
+			focusNode = { };
 			if (!tutorialPassed && tutorialStep == 1) {
 				tutorialStep = 0;
 			}
 		}
 		/*if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-			addNode(mousePosition);
+			focusNode = activeLevel->AddNode(mousePosition);
 			AddJoint(selectedNode, focusNode);
 			selectedNode = nullptr;
 			focusNode = nullptr;
@@ -294,227 +455,144 @@ void SceneManager::checkNodesCollision()
 	}
 }
 
-void scene::SceneManager::checkCarCollision()
+bool SceneManager::checkEntityCollision(EntityHandle node, Vector2 point)
 {
-	if (CheckCollisionPointRec(m_car.GetPosition(), Rectangle{
-				passedEntity.pos.x,
-				passedEntity.pos.y,
-				passedEntity.extent.x,
-				passedEntity.extent.y
-		}) && state != LevelState::PASSED) {
-		state = LevelState::PASSED;
-		m_car.SetSpeed(0.0f);
-		StopMusicStream(Resources::effectCar);
-	}
-
-	if (CheckCollisionPointRec(m_car.GetPosition(), Rectangle{
-				loseEntity.pos.x,
-				loseEntity.pos.y,
-				loseEntity.extent.x,
-				loseEntity.extent.y
-		}) && state != LevelState::LOSE) {
-		state = LevelState::LOSE;
-		m_car.SetSpeed(0.0f);
-		StopMusicStream(Resources::effectCar);
-		core::Core::getInstance()->OnLose();
+	constexpr auto MOUSE_SCALE_MARK_SIZE = Level::nodePickMargin;
+	int index = activeLevel->Nodes().Find(node);
+	if (index < 0) {
+		return false;
 	}
-}
-
-bool SceneManager::checkEntityCollision(Entity* entity, Vector2 point)
-{
-	constexpr auto MOUSE_SCALE_MARK_SIZE = 12;
+	Rectangle bounds = activeLevel->Nodes().Bounds(index);
 	return CheckCollisionPointRec(point, Rectangle {
-			entity->pos.x - MOUSE_SCALE_MARK_SIZE,
-			entity->pos.y - MOUSE_SCALE_MARK_SIZE,
-			entity->extent.x + MOUSE_SCALE_MARK_SIZE,
-			entity->extent.y + MOUSE_SCALE_MARK_SIZE
+			bounds.x - MOUSE_SCALE_MARK_SIZE,
+			bounds.y - MOUSE_SCALE_MARK_SIZE,
+			bounds.width + MOUSE_SCALE_MARK_SIZE,
+			bounds.height + MOUSE_SCALE_MARK_SIZE
 		});
 }
 
 void SceneManager::Draw()
 {
-    Vector2 center = Vector2Scale({ (float)core::gameScreenWidth , (float)core::gameScreenHeight }, 1.0f);
-	worldCamera.offset = {};
-    worldCamera.target = {};
-    worldCamera.zoom = 1.0f;
-    float screenSize[2] = { (float)core::gameScreenWidth, (float)core::gameScreenHeight };
-
+	PROFILE_SCOPE("SceneManager::Draw");
     BeginMode2D(worldCamera);
-        Rectangle screen = { 0, 0,  center.x * 2,  center.y * 2 };
-        Vector2 screenOriginInWorld = GetScreenToWorld2D(Vector2Zero(), worldCamera);
-        Vector2 screenEdgeInWorld = GetScreenToWorld2D(Vector2{ screen.width, screen.height }, worldCamera);
-        screenInWorld = Rectangle{ screenOriginInWorld.x, screenOriginInWorld.y, screenEdgeInWorld.x - screenOriginInWorld.x,screenEdgeInWorld.y - screenOriginInWorld.y };
-
-		DrawTextureRec(renderedLevelTexture,
-			{ 0, 0, (float)renderedLevelTexture.width, (float)-renderedLevelTexture.height },
-			{ 0, 0 }, WHITE);
+		tilemap.Draw(screenInWorld);
 		if (!tutorialPassed) {
 			DrawTexture(tutorials[tutorialStep], tutorialPos[tutorialStep].x, tutorialPos[tutorialStep].y, WHITE);
 		}
-		if (selectedNode) {
-			DrawEntity(*selectedNode, R_D_BLUE);
+		const EntityStore& nodes = activeLevel->Nodes();
+		int selectedIndex = nodes.Find(selectedNode);
+		if (selectedIndex >= 0) {
+			DrawEntity(nodes, selectedIndex, R_D_BLUE);
+			Rectangle bounds = nodes.Bounds(selectedIndex);
 			DrawLineEx(Vector2 {
-				selectedNode->pos.x + selectedNode->extent.x / 2.0f,
-				selectedNode->pos.y + selectedNode->extent.y / 2.0f
+				bounds.x + bounds.width / 2.0f,
+				bounds.y + bounds.height / 2.0f
 			}, Vector2{
-				mousePosition.x + selectedNode->extent.x / 2.0f,
-				mousePosition.y + selectedNode->extent.y / 2.0f
+				mousePosition.x + bounds.width / 2.0f,
+				mousePosition.y + bounds.height / 2.0f
 			}, 5.0f, R_RED);
 		}
-		for (auto& entity : nodeEntities) {
-			DrawEntity(entity, R_DDBLUE);
-		}
-		for (auto& entity : jointBodyEntities) {
-			DrawJointBodies(entity, R_DDBLUE);
-		}
+		drawBridge();
 
-		if (focusNode) {
-			DrawEntity(*focusNode, R_RED);
+		int focusIndex = nodes.Find(focusNode);
+		if (focusIndex >= 0) {
+			DrawEntity(nodes, focusIndex, R_RED);
 		}
 
 #ifdef _DEBUG
-		/*for (auto& entity : groundEntities) {
-			DrawEntity(entity, WHITE);
+		/*for (int i = 0; i < activeLevel->Grounds().Size(); i++) {
+			DrawEntity(activeLevel->Grounds(), i, WHITE);
 		}
-		for (auto& entity : nodeEntities) {
-			DrawEntity(entity, RED);
+		for (int i = 0; i < nodes.Size(); i++) {
+			DrawEntity(nodes, i, RED);
 		}
-		for (auto& entity : jointBodyEntities) {
-			DrawEntity(entity, RED);
-			DrawRectangleLines(entity.pos.x, entity.pos.y, entity.extent.x, entity.extent.y, RED);
+		for (int i = 0; i < activeLevel->JointBodies().Size(); i++) {
+			DrawEntity(activeLevel->JointBodies(), i, RED);
 		}*/
 #endif
-	m_car.Draw();
+	activeLevel->GetCar().Draw(activeLevel->GetAlpha());
     EndMode2D();
 }
 
-void SceneManager::DrawEntity(const Entity& entity, Color color)
+void SceneManager::DrawEntity(const EntityStore& store, int index, Color color)
 {
-	if (entity.bodyId) {
-		b2Vec2 p = b2Body_GetWorldPoint(entity.bodyId.value(), b2Vec2{-entity.extent.x / 2.0f, -entity.extent.y / 2.0f});
-		b2Rot rotation = b2Body_GetRotation(entity.bodyId.value());
-		float radians = b2Rot_GetAngle(rotation);
+	b2Vec2 extent = store.Extent(index);
+	if (store.HasBody(index)) {
+		b2Transform transform = activeLevel->GetInterpolatedTransform(store, index);
+		b2Vec2 p = b2TransformPoint(transform, b2Vec2{-extent.x / 2.0f, -extent.y / 2.0f});
+		float radians = b2Rot_GetAngle(transform.q);
 		Vector2 ps = { p.x, p.y };
-		DrawRectanglePro(Rectangle { ps.x, ps.y, entity.extent.x, entity.extent.y }, { 0.0f, 0.0f }, RAD2DEG* radians, color);
-		p = b2Body_GetWorldPoint(entity.bodyId.value(), b2Vec2{0.0f, 0.0f});
-		ps = { p.x, p.y };
+		DrawRectanglePro(Rectangle { ps.x, ps.y, extent.x, extent.y }, { 0.0f, 0.0f }, RAD2DEG* radians, color);
+		ps = { transform.p.x, transform.p.y };
 		DrawCircleV(ps, 2.0f, R_GOLD);
 	}
-	DrawRectangleLines(entity.pos.x, entity.pos.y, entity.extent.x, entity.extent.y, color);
+	Rectangle bounds = store.Bounds(index);
+	DrawRectangleLines(bounds.x, bounds.y, bounds.width, bounds.height, color);
 }
 
-void scene::SceneManager::DrawJointBodies(const Entity& entity, Color color)
+// Every node and beam in one submission, the same shapes DrawEntity draws one at a time
+void SceneManager::drawBridge()
 {
-	b2Vec2 p = b2Body_GetWorldPoint(entity.bodyId.value(), b2Vec2{ -entity.extent.x / 2.0f, -entity.extent.y / 2.0f });
-	b2Rot rotation = b2Body_GetRotation(entity.bodyId.value());
-	float radians = b2Rot_GetAngle(rotation);
-	Vector2 ps = { p.x, p.y };
-	DrawRectanglePro(Rectangle{ ps.x, ps.y, entity.extent.x, entity.extent.y }, { 0.0f, 0.0f }, RAD2DEG * radians, color);
-	p = b2Body_GetWorldPoint(entity.bodyId.value(), b2Vec2{ 0.0f, 0.0f });
-	ps = { p.x, p.y };
-	DrawCircleV(ps, 2.0f, R_GOLD);
+	const EntityStore& nodes = activeLevel->Nodes();
+	const EntityStore& beams = activeLevel->JointBodies();
+	float alpha = activeLevel->GetAlpha();
+	bridgeRenderer.Begin();
+	for (int i = 0; i < nodes.Size(); i++) {
+		b2Transform transform = nodes.Transform(i);
+		bridgeRenderer.AddBox(transform, nodes.Extent(i), R_DDBLUE);
+		bridgeRenderer.AddDot({ transform.p.x, transform.p.y }, 2.0f, R_GOLD);
+		bridgeRenderer.AddRectangleLines(nodes.Bounds(i), R_DDBLUE);
+	}
+	const auto& current = beams.Transforms();
+	for (int i = 0; i < beams.Size(); i++) {
+		b2Transform transform = LerpTransform(beams.PreviousTransform(i), current[i], alpha);
+		bridgeRenderer.AddBox(transform, beams.Extent(i), R_DDBLUE);
+		bridgeRenderer.AddDot({ transform.p.x, transform.p.y }, 2.0f, R_GOLD);
+	}
+	bridgeRenderer.Draw();
 }
 
 void SceneManager::DrawJoint(const Joint& joint)
 {
+	int node = activeLevel->Nodes().Find(joint.node);
+	int beam = activeLevel->JointBodies().Find(joint.beam);
+	if (node < 0 || beam < 0) {
+		return;
+	}
+	Rectangle nodeBounds = activeLevel->Nodes().Bounds(node);
+	b2Vec2 beamCenter = b2Body_GetPosition(activeLevel->JointBodies().BodyId(beam));
 	DrawLineEx(Vector2{
-				joint.nodeA->pos.x + joint.nodeA->extent.x / 2.0f,
-				joint.nodeA->pos.y + joint.nodeA->extent.y / 2.0f
-		}, Vector2{
-			joint.nodeB->pos.x + joint.nodeB->extent.x / 2.0f,
-			joint.nodeB->pos.y + joint.nodeB->extent.y / 2.0f
-		}, 5.0f, R_RED);
-}
-
-void SceneManager::AddJoint(Entity* entityA, Entity* entityB)
-{
-	if (entityA->pos.x > entityB->pos.x) {
-		std::swap(entityA, entityB);
-	}
-	auto width = Vector2Distance(entityA->pos, entityB->pos);
-	auto boxWidth = width / 2.0f - 8.0f;
-	auto boxHeight = 5.f;
-	b2Polygon box = b2MakeBox(boxWidth, boxHeight);
-	b2ShapeDef shapeDef = b2DefaultShapeDef();
-	b2BodyDef bodyDef = b2DefaultBodyDef();
-	bodyDef.type = b2_dynamicBody;
-	bodyDef.position = { entityA->pos.x + width / 2.0f + entityA->extent.x / 2.0f + 2.0f, entityA->pos.y + boxHeight - entityA->extent.y + 2.0f};
-	auto angle = RAD2DEG * Vector2Angle(entityA->pos, entityB->pos);
-	bodyDef.enableSleep = false;
-	auto bodyId = b2CreateBody(worldId.value(), &bodyDef);
-	b2CreatePolygonShape(bodyId, &shapeDef, &box);
-	Entity localEntity;
-	localEntity.pos = { entityA->pos.x + 7.0f, entityA->pos.y };
-	localEntity.bodyId = bodyId;
-	localEntity.extent = { boxWidth * 2.0f, boxHeight * 2.0f };
-	
-	auto jointDef = b2DefaultWeldJointDef();
-	b2Vec2 pivot = { 0.0f, 0.5f };
-	jointDef.bodyIdA = entityA->bodyId.value();
-	jointDef.bodyIdB = bodyId;
-	jointDef.localAnchorA = b2Body_GetLocalPoint(jointDef.bodyIdA, {0.5f, 0.5f});
-	jointDef.localAnchorB = b2Body_GetLocalPoint(jointDef.bodyIdB, pivot);
-	jointDef.angularHertz = 20.0f;
-	jointDef.angularDampingRatio = 10.0f;
-	jointDef.linearHertz = 10.0f;
-	jointDef.linearDampingRatio = 15.0f;
-	jointDef.collideConnected = true;
-	auto id = b2CreateWeldJoint(worldId.value(), &jointDef);
-	Joint joint { entityA, &localEntity, id };
-
-	pivot = { 1.0f, 0.5f };
-	jointDef.bodyIdA = bodyId;
-	jointDef.bodyIdB = entityB->bodyId.value();
-	jointDef.localAnchorA = b2Body_GetLocalPoint(jointDef.bodyIdA, pivot);
-	jointDef.localAnchorB = b2Body_GetLocalPoint(jointDef.bodyIdB, {0.5f, 0.5f});
-	jointDef.angularHertz = 20.0f;
-	jointDef.angularDampingRatio = 10.0f;
-	jointDef.linearHertz = 10.0f;
-	jointDef.linearDampingRatio = 15.0f;
-	jointDef.collideConnected = true;
-	id = b2CreateWeldJoint(worldId.value(), &jointDef);
-	Joint joint2{ &localEntity, entityB, id };
-
-	jointEntities.emplace_back(joint);
-	jointEntities.emplace_back(joint2);
-	jointBodyEntities.emplace_back(localEntity);
-
-}
-
-void SceneManager::addNode(Vector2 position)
-{
-	Entity localEntity;
-	localEntity.extent = { 8.0f, 8.0f };
-	auto b2width = localEntity.extent.x / 2.0f;
-	auto b2height = localEntity.extent.y / 2.0f;
-
-	auto centerX = position.x + b2width;
-	auto centerY = position.y + b2height;
-
-	b2BodyDef bodyDef = b2DefaultBodyDef();
-	bodyDef.position = { centerX, centerY };
-
-	b2BodyId body = b2CreateBody(worldId.value(), &bodyDef);
-
-	b2BodyId groundId = b2CreateBody(worldId.value(), &bodyDef);
-
-	b2Polygon groundBox = b2MakeBox(b2width, b2height);
-	b2ShapeDef groundShapeDef = b2DefaultShapeDef();
-	b2CreatePolygonShape(groundId, &groundShapeDef, &groundBox);
-	localEntity.pos = position;
-	localEntity.bodyId = groundId;
-	focusNode = &nodeEntities.emplace_back(localEntity);
+				nodeBounds.x + nodeBounds.width / 2.0f,
+				nodeBounds.y + nodeBounds.height / 2.0f
+		}, Vector2{ beamCenter.x, beamCenter.y }, 5.0f, R_RED);
 }
 
 void SceneManager::Reset()
 {
-	m_car.Despawn();
-	b2DestroyWorld(worldId.value());
-	groundEntities.clear();
-	nodeEntities.clear();
-	jointEntities.clear();
-	jointBodyEntities.clear();
-	UnloadTexture(currentTilesetTexture);
-	passedEntity = {};
-	loseEntity = {};
-}
\ No newline at end of file
+	PROFILE_SCOPE("SceneManager::Reset");
+	focusNode = { };
+	selectedNode = { };
+	editHistory.Clear();
+	activeLevel->Destroy();
+}
+
+// The tilemap and level textures are kept as they are; only the world is replaced
+void SceneManager::Restart()
+{
+	PROFILE_SCOPE("SceneManager::Restart");
+	recordInput(InputType::Restart);
+	// Rebuild in place rather than wait for a spare that is still building
+	bool spareReady = spareLevel.valid() && (spareLevelIndex == currentLevel) &&
+		(spareLevel.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+	if (!spareReady) {
+		Reset();
+		Load();
+		return;
+	}
+	focusNode = { };
+	selectedNode = { };
+	editHistory.Clear();
+	std::unique_ptr<Level> used = std::move(activeLevel);
+	activeLevel = spareLevel.get();
+	prepareSpareLevel(std::move(used));
+}
@@ -0,0 +1,206 @@
+#include "startup_loader.h"
+
+#include <stdio.h>
+#include "audio_system.h"
+#include "resource.h"
+#include "resource_cache.h"
+#include "scene_manager.h"
+
+using namespace core;
+
+namespace
+{
+    constexpr int fontSize = 64;
+    constexpr int fontGlyphCount = 250;
+    // Same padding LoadFontEx gives the atlas
+    constexpr int fontGlyphPadding = 4;
+    constexpr const char* effectFiles[] = { "effect1.mp3", "effect2.mp3", "effect3.mp3", "effect4.mp3" };
+}
+
+double StartupLoader::elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+template <typename Result, typename Work>
+StartupLoader::Pending<Result> StartupLoader::launch(std::string name, Work work)
+{
+#if defined(PLATFORM_WEB)
+    // No threads on the web build, each asset is loaded when Finish() asks for it
+    auto policy = std::launch::deferred;
+#else
+    auto policy = std::launch::async;
+#endif
+    Pending<Result> pending;
+    pending.name = std::move(name);
+    pending.result = std::async(policy, [work]() {
+        auto start = Clock::now();
+        Timed<Result> timed { work(), 0.0 };
+        timed.ms = elapsedMs(start);
+        return timed;
+    });
+    return pending;
+}
+
+// LoadFontEx without the texture upload: glyph rasterising and atlas packing are CPU only
+StartupLoader::DecodedFont StartupLoader::decodeFont(const std::string& path, int size, int glyphCount)
+{
+    DecodedFont decoded;
+    decoded.font.baseSize = size;
+    decoded.font.glyphCount = glyphCount;
+    AssetData file = ResourcePack::getInstance()->Read(path);
+    if (!file)
+    {
+        return decoded;
+    }
+    decoded.font.glyphs = LoadFontData(file.Data(), file.Size(), size, nullptr, glyphCount, FONT_DEFAULT);
+    if (!decoded.font.glyphs)
+    {
+        return decoded;
+    }
+    decoded.font.glyphPadding = fontGlyphPadding;
+    decoded.atlas = GenImageFontAtlas(decoded.font.glyphs, &decoded.font.recs, glyphCount, size, fontGlyphPadding, 0);
+    for (int i = 0; i < glyphCount; i++)
+    {
+        UnloadImage(decoded.font.glyphs[i].image);
+        decoded.font.glyphs[i].image = ImageFromImage(decoded.atlas, decoded.font.recs[i]);
+    }
+    return decoded;
+}
+
+void StartupLoader::Start(const std::string& directory)
+{
+    dir = directory;
+    auto* pack = ResourcePack::getInstance();
+    std::string fontPath = dir + "/SCHABO-Condensed.otf";
+    font = launch<DecodedFont>("SCHABO-Condensed.otf", [fontPath]() { return decodeFont(fontPath, fontSize, fontGlyphCount); });
+    std::string carPath = dir + "/car.png";
+    carTexture = launch<Image>("car.png", [pack, carPath]() { return pack->LoadImage(carPath); });
+    std::string wheelPath = dir + "/wheel.png";
+    wheelTexture = launch<Image>("wheel.png", [pack, wheelPath]() { return pack->LoadImage(wheelPath); });
+    for (int i = 0; i < 3; i++)
+    {
+        std::string name = "tutorial" + std::to_string(i) + ".png";
+        std::string path = dir + "/" + name;
+        tutorialImages.push_back(launch<scene::DecodedImage>(name, [pack, path]() {
+            return scene::DecodedImage { path, pack->LoadImage(path) };
+        }));
+    }
+    for (const char* name : effectFiles)
+    {
+        std::string path = dir + "/" + name;
+        effects.push_back(launch<Wave>(name, [pack, path]() { return pack->LoadWave(path); }));
+    }
+    // The engine loop is held in memory still encoded, decoded as it plays
+    std::string enginePath = dir + "/car.ogg";
+    engineLoop = launch<AssetData>("car.ogg", [pack, enginePath]() { return pack->Read(enginePath); });
+    std::string projectDir = dir;
+    project = launch<DecodedProject>("levels", [pack, projectDir]() {
+        DecodedProject decoded;
+        decoded.project = scene::SceneManager::LoadLevelProject(projectDir);
+        if (decoded.project->Count() > 0)
+        {
+            for (auto& path : scene::SceneManager::LevelTexturePaths(decoded.project->Get(0), projectDir))
+            {
+                decoded.images.push_back(scene::DecodedImage { path, pack->LoadImage(path) });
+            }
+        }
+        return decoded;
+    });
+}
+
+void StartupLoader::Finish()
+{
+    auto finishStart = Clock::now();
+    auto take = [this](auto& pending, auto upload) {
+        auto timed = pending.result.get();
+        auto start = Clock::now();
+        upload(timed.value);
+        timings.push_back(StartupTiming { pending.name, timed.ms, elapsedMs(start) });
+    };
+    auto* cache = ResourceCache::getInstance();
+    auto* audio = AudioSystem::getInstance();
+    auto prime = [this, cache](scene::DecodedImage& decoded) {
+        cache->AcquireTexture(decoded.path, decoded.image);
+        UnloadImage(decoded.image);
+        primedTextures.push_back(decoded.path);
+    };
+
+    take(font, [](DecodedFont& decoded) {
+        if (decoded.font.glyphs)
+        {
+            decoded.font.texture = LoadTextureFromImage(decoded.atlas);
+            UnloadImage(decoded.atlas);
+            Resources::baseFont = decoded.font;
+        }
+        else
+        {
+            Resources::baseFont = GetFontDefault();
+        }
+    });
+    take(carTexture, [](Image& image) {
+        Resources::car = LoadTextureFromImage(image);
+        UnloadImage(image);
+    });
+    take(wheelTexture, [](Image& image) {
+        Resources::wheel = LoadTextureFromImage(image);
+        UnloadImage(image);
+    });
+    for (auto& pending : tutorialImages)
+    {
+        take(pending, prime);
+    }
+
+    core::EffectId* effectIds[] = { &Resources::effect, &Resources::effect2, &Resources::effect3, &Resources::effect4 };
+    for (size_t i = 0; i < effects.size(); i++)
+    {
+        take(effects[i], [audio, id = effectIds[i]](Wave& wave) {
+            *id = audio->LoadEffect(wave);
+            UnloadWave(wave);
+        });
+    }
+    std::string engineType = GetFileExtension(engineLoop.name.c_str());
+    take(engineLoop, [audio, engineType](AssetData& file) {
+        Resources::effectCar = audio->LoadStream(engineType, std::move(file));
+    });
+    // Streamed from the pack or the disk, opening it only reads the header
+    RunOnMain("main.mp3", [this, audio]() { Resources::music = audio->LoadStream(dir + "/main.mp3"); });
+
+    take(project, [this, &prime](DecodedProject& decoded) {
+        levelProject = std::move(decoded.project);
+        for (auto& image : decoded.images)
+        {
+            prime(image);
+        }
+    });
+    tutorialImages.clear();
+    effects.clear();
+    finishMs = elapsedMs(finishStart);
+}
+
+// Call once the scene holds its own references
+void StartupLoader::ReleasePrimedTextures()
+{
+    auto* cache = ResourceCache::getInstance();
+    for (auto& path : primedTextures)
+    {
+        cache->ReleaseTexture(path);
+    }
+    primedTextures.clear();
+}
+
+// Printed rather than logged: release builds silence the raylib log
+void StartupLoader::Report(double firstFrameMs) const
+{
+    double workerMs = 0.0;
+    double mainMs = 0.0;
+    printf("STARTUP: %-24s %10s %10s\n", "asset", "worker ms", "main ms");
+    for (auto& timing : timings)
+    {
+        printf("STARTUP: %-24s %10.2f %10.2f\n", timing.name.c_str(), timing.workerMs, timing.mainMs);
+        workerMs += timing.workerMs;
+        mainMs += timing.mainMs;
+    }
+    printf("STARTUP: %.1f ms decoding on workers, %.1f ms on the main thread, %.1f ms waiting for assets, first frame after %.1f ms\n",
+        workerMs, mainMs, finishMs, firstFrameMs);
+}
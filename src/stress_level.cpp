@@ -0,0 +1,122 @@
+#include "stress_level.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+
+using namespace scene;
+
+namespace
+{
+    // Proportions of the shipped levels: 8px grid, 80px static blocks, cliff tops at 304
+    constexpr float groundY = 304.0f;
+    constexpr float cliffWidth = 400.0f;
+    constexpr float blockSize = 80.0f;
+    constexpr float nodeSize = 8.0f;
+    constexpr float rowSpacing = 40.0f;
+    constexpr float cellSize = 8.0f;
+    constexpr float tileSize = 8.0f;
+    constexpr Vector2 surfaceTile = { 32.0f, 0.0f };
+    constexpr Vector2 fillTile = { 40.0f, 0.0f };
+
+    void addCliff(LevelData& data, float x, float width)
+    {
+        for (float blockX = x; blockX < x + width; blockX += blockSize)
+        {
+            data.statics.push_back({ blockX, groundY, std::min(blockSize, x + width - blockX), data.size.y - groundY });
+        }
+    }
+
+    void addTiles(TileLayerData& layer, const Rectangle& rect)
+    {
+        for (float y = rect.y; y < rect.y + rect.height; y += tileSize)
+        {
+            for (float x = rect.x; x < rect.x + rect.width; x += tileSize)
+            {
+                Vector2 source = (y == rect.y) ? surfaceTile : fillTile;
+                layer.tiles.push_back({ { source.x, source.y, tileSize, tileSize }, { x, y } });
+            }
+        }
+    }
+}
+
+StressLevel scene::GenerateStressLevel(const StressLevelOptions& options)
+{
+    int rows = std::max(options.rows, 1);
+    int columns = std::max((options.nodeCount + rows - 1)/rows, 2);
+    float spacing = std::max(options.spacing, 2.0f*nodeSize + 8.0f);
+    float chasmWidth = (columns - 1)*spacing;
+    float deckDepth = (rows - 1)*rowSpacing;
+
+    StressLevel level;
+    LevelData& data = level.data;
+    data.name = "Stress_" + std::to_string(columns*rows);
+    data.size = { cliffWidth*2.0f + chasmWidth, std::max(540.0f, groundY + deckDepth + 240.0f) };
+    data.size.y = std::ceil(data.size.y/cellSize)*cellSize;
+    data.background = "bg.png";
+    data.hasCar = true;
+    data.carPosition = { cliffWidth - 160.0f, groundY - 72.0f };
+
+    float chasmLeft = cliffWidth;
+    float chasmRight = cliffWidth + chasmWidth;
+    addCliff(data, 0.0f, cliffWidth);
+    addCliff(data, chasmRight, cliffWidth);
+    data.passed = { chasmRight + 56.0f, groundY - blockSize, blockSize, blockSize };
+    data.lose = { chasmLeft, data.size.y - 120.0f, chasmWidth, 120.0f };
+
+    // Bumpy floor from the IntGrid path, so the merged terrain boxes scale with the width
+    auto gridColumns = static_cast<int>(data.size.x/cellSize);
+    auto gridRows = static_cast<int>(data.size.y/cellSize);
+    std::vector<uint8_t> solid(static_cast<size_t>(gridColumns)*gridRows, 0);
+    std::mt19937 random(options.seed);
+    std::uniform_int_distribution<int> bump(1, 4);
+    int firstColumn = static_cast<int>(chasmLeft/cellSize);
+    int lastColumn = std::min(static_cast<int>(chasmRight/cellSize), gridColumns);
+    for (int x = firstColumn; x < lastColumn; x += 4)
+    {
+        int height = bump(random);
+        for (int column = x; column < std::min(x + 4, lastColumn); column++)
+        {
+            for (int y = gridRows - height; y < gridRows; y++)
+            {
+                solid[static_cast<size_t>(y)*gridColumns + column] = 1;
+            }
+        }
+    }
+    data.terrain = MergeSolidCells(solid, gridColumns, gridRows, cellSize);
+
+    for (int row = 0; row < rows; row++)
+    {
+        for (int column = 0; column < columns; column++)
+        {
+            data.nodes.push_back({ chasmLeft + column*spacing, groundY + row*rowSpacing, nodeSize, nodeSize });
+        }
+    }
+    // Beams are always created level (Level::AddJoint lays the box along x), so every
+    // row gets its own deck instead of vertical or diagonal bracing
+    for (int row = 0; row < rows; row++)
+    {
+        for (int column = 0; column + 1 < columns; column++)
+        {
+            level.bridge.joints.emplace_back(row*columns + column, row*columns + column + 1);
+        }
+    }
+
+    if (options.tiles)
+    {
+        TileLayerData layer;
+        layer.tileset = "tile.png";
+        for (auto& rect : data.statics)
+        {
+            addTiles(layer, rect);
+        }
+        for (auto& rect : data.terrain)
+        {
+            addTiles(layer, rect);
+        }
+        data.tileLayers.emplace_back(std::move(layer));
+    }
+    return level;
+}
@@ -0,0 +1,61 @@
+#include "substep_controller.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include "raylib.h"
+
+using namespace scene;
+
+SubStepOptions SubStepController::DefaultOptions()
+{
+    SubStepOptions options;
+    if (const char* value = std::getenv("NEXTJAM_STEP_BUDGET_MS"))
+    {
+        float budget = static_cast<float>(std::atof(value));
+        if (budget > 0.0f)
+        {
+            options.stepBudgetMs = budget;
+        }
+    }
+    return options;
+}
+
+int SubStepController::Update(int current, float jointError, float stepMs)
+{
+    current = std::clamp(current, options.minSubSteps, options.maxSubSteps);
+    // Step time grows about linearly with the sub-step count
+    float costPerSubStep = stepMs / current;
+    int chosen = current;
+    if (stepMs > options.stepBudgetMs)
+    {
+        chosen = current - 1;
+        calm = 0;
+    }
+    else if (jointError > options.raiseError)
+    {
+        if (stepMs + costPerSubStep <= options.stepBudgetMs)
+        {
+            chosen = current + 1;
+        }
+        calm = 0;
+    }
+    else if (jointError < options.lowerError)
+    {
+        if (++calm >= options.calmUpdates)
+        {
+            chosen = current - 1;
+            calm = 0;
+        }
+    }
+    else
+    {
+        calm = 0;
+    }
+
+    chosen = std::clamp(chosen, options.minSubSteps, options.maxSubSteps);
+    if (chosen != current)
+    {
+        TraceLog(LOG_INFO, "PHYSICS: %i sub-steps (joint error %.2f px, step %.2f ms)", chosen, jointError, stepMs);
+    }
+    return chosen;
+}
@@ -0,0 +1,157 @@
+#include "tilemap_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace scene;
+
+TilemapRenderer::~TilemapRenderer()
+{
+    Unload();
+}
+
+void TilemapRenderer::Build(const LevelData& data, Texture2D background, const std::vector<Texture2D>& tilesets)
+{
+    Unload();
+    this->background = background;
+    this->tilesets = tilesets;
+    columns = std::max(1, static_cast<int>(std::ceil(data.size.x / chunkSize)));
+    rows = std::max(1, static_cast<int>(std::ceil(data.size.y / chunkSize)));
+    chunks.resize(static_cast<size_t>(columns) * rows);
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < columns; x++)
+        {
+            chunks[y * columns + x].bounds = Rectangle {
+                float(x * chunkSize),
+                float(y * chunkSize),
+                std::min(float(chunkSize), data.size.x - x * chunkSize),
+                std::min(float(chunkSize), data.size.y - y * chunkSize)
+            };
+        }
+    }
+
+    // A tile crossing a chunk edge is drawn into every chunk it touches
+    for (int layer = 0; layer < static_cast<int>(data.tileLayers.size()); layer++)
+    {
+        for (auto& tile : data.tileLayers[layer].tiles)
+        {
+            int x0, y0, x1, y1;
+            Rectangle area = { tile.position.x, tile.position.y, std::abs(tile.source.width), std::abs(tile.source.height) };
+            if (!visibleRange(area, x0, y0, x1, y1))
+            {
+                continue;
+            }
+            for (int y = y0; y <= y1; y++)
+            {
+                for (int x = x0; x <= x1; x++)
+                {
+                    chunks[y * columns + x].tiles.push_back(ChunkTile { layer, tile });
+                }
+            }
+        }
+    }
+}
+
+void TilemapRenderer::Unload()
+{
+    for (auto& chunk : chunks)
+    {
+        evict(chunk);
+    }
+    chunks.clear();
+    tilesets.clear();
+    background = { };
+    columns = 0;
+    rows = 0;
+}
+
+bool TilemapRenderer::visibleRange(Rectangle view, int& x0, int& y0, int& x1, int& y1) const
+{
+    x0 = std::max(0, static_cast<int>(std::floor(view.x / chunkSize)));
+    y0 = std::max(0, static_cast<int>(std::floor(view.y / chunkSize)));
+    x1 = std::min(columns - 1, static_cast<int>(std::ceil((view.x + view.width) / chunkSize)) - 1);
+    y1 = std::min(rows - 1, static_cast<int>(std::ceil((view.y + view.height) / chunkSize)) - 1);
+    return (x0 <= x1) && (y0 <= y1);
+}
+
+void TilemapRenderer::Update(Rectangle view)
+{
+    frame++;
+    int x0, y0, x1, y1;
+    if (visibleRange(view, x0, y0, x1, y1))
+    {
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                Chunk& chunk = chunks[y * columns + x];
+                chunk.lastVisibleFrame = frame;
+                if (!chunk.resident && !chunk.tiles.empty())
+                {
+                    bake(chunk);
+                }
+            }
+        }
+    }
+    for (auto& chunk : chunks)
+    {
+        if (chunk.resident && (frame - chunk.lastVisibleFrame > evictAfterFrames))
+        {
+            evict(chunk);
+        }
+    }
+}
+
+void TilemapRenderer::bake(Chunk& chunk)
+{
+    chunk.target = LoadRenderTexture(static_cast<int>(chunk.bounds.width), static_cast<int>(chunk.bounds.height));
+    BeginTextureMode(chunk.target);
+    ClearBackground(BLANK);
+    for (auto& tile : chunk.tiles)
+    {
+        Vector2 position = { tile.draw.position.x - chunk.bounds.x, tile.draw.position.y - chunk.bounds.y };
+        DrawTextureRec(tilesets[tile.layer], tile.draw.source, position, WHITE);
+    }
+    EndTextureMode();
+    chunk.resident = true;
+    residentCount++;
+}
+
+void TilemapRenderer::evict(Chunk& chunk)
+{
+    if (!chunk.resident)
+    {
+        return;
+    }
+    UnloadRenderTexture(chunk.target);
+    chunk.target = { };
+    chunk.resident = false;
+    residentCount--;
+}
+
+void TilemapRenderer::Draw(Rectangle view) const
+{
+    if (background.id != 0)
+    {
+        DrawTextureV(background, { }, WHITE);
+    }
+    int x0, y0, x1, y1;
+    if (!visibleRange(view, x0, y0, x1, y1))
+    {
+        return;
+    }
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            const Chunk& chunk = chunks[y * columns + x];
+            if (!chunk.resident)
+            {
+                continue;
+            }
+            auto& texture = chunk.target.texture;
+            DrawTextureRec(texture, { 0, 0, (float)texture.width, (float)-texture.height }, { chunk.bounds.x, chunk.bounds.y }, WHITE);
+        }
+    }
+}
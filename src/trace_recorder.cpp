@@ -0,0 +1,230 @@
+#include "trace_recorder.h"
+
+#if defined(NEXTJAM_PROFILER)
+#include "raylib.h"
+#include "profiler.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace core;
+
+namespace
+{
+    // Slots are guarded by a sequence number: odd while the owner thread writes it,
+    // 2 * (event index + 1) once it is complete, so a reader can skip torn slots
+    struct TraceSlot
+    {
+        std::atomic<uint64_t> sequence { 0 };
+        std::atomic<const char*> name { nullptr };
+        std::atomic<int64_t> start { 0 };
+        std::atomic<int64_t> duration { 0 };
+    };
+
+    struct ThreadBuffer
+    {
+        int threadId = 0;
+        std::string name;
+        std::atomic<uint64_t> written { 0 };
+        std::vector<TraceSlot> slots = std::vector<TraceSlot>(TraceRecorder::eventsPerThread);
+    };
+
+    // Buffers outlive their thread: a finished thread hands its buffer to the free list
+    // and the next new thread takes it over, so threads started per level load or
+    // restart reuse a few buffers instead of adding one each. A freed buffer keeps its
+    // events for Dump until it is taken over.
+    struct TraceState
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::vector<ThreadBuffer*> freeBuffers;
+        int nextThreadId = 1;
+        TraceRecorder::Clock::time_point epoch = TraceRecorder::Clock::now();
+        double budgetMs = 20.0;
+        int frame = 0;
+        int dumpCount = 0;
+        TraceRecorder::Clock::time_point lastDump;
+    };
+
+    TraceState& state()
+    {
+        static TraceState traceState;
+        return traceState;
+    }
+
+    // Owns the calling thread's buffer, returning it to the free list when the thread ends
+    struct BufferOwner
+    {
+        ThreadBuffer* buffer = nullptr;
+        std::string name;              // set by SetThreadName, used once a buffer is taken
+
+        ~BufferOwner()
+        {
+            if (buffer)
+            {
+                TraceState& trace = state();
+                std::lock_guard<std::mutex> lock(trace.mutex);
+                trace.freeBuffers.push_back(buffer);
+            }
+        }
+    };
+
+    thread_local BufferOwner threadOwner;
+
+    ThreadBuffer& currentBuffer()
+    {
+        if (!threadOwner.buffer)
+        {
+            TraceState& trace = state();
+            std::lock_guard<std::mutex> lock(trace.mutex);
+            ThreadBuffer* buffer = nullptr;
+            if (!trace.freeBuffers.empty())
+            {
+                // Dump reads written under the lock, so the old events drop out at once
+                buffer = trace.freeBuffers.back();
+                trace.freeBuffers.pop_back();
+                buffer->written.store(0, std::memory_order_relaxed);
+            }
+            else
+            {
+                trace.buffers.emplace_back(std::make_unique<ThreadBuffer>());
+                buffer = trace.buffers.back().get();
+            }
+            buffer->threadId = trace.nextThreadId++;
+            buffer->name = threadOwner.name.empty() ? "thread " + std::to_string(buffer->threadId) : threadOwner.name;
+            threadOwner.buffer = buffer;
+        }
+        return *threadOwner.buffer;
+    }
+
+    int64_t microseconds(TraceRecorder::Clock::duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    }
+}
+
+void TraceRecorder::Configure(int argc, char** argv)
+{
+    bool enable = false;
+    if (const char* value = std::getenv("NEXTJAM_TRACE"))
+    {
+        enable = (std::strcmp(value, "0") != 0);
+    }
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--trace") == 0)
+        {
+            enable = true;
+        }
+    }
+    if (const char* value = std::getenv("NEXTJAM_TRACE_BUDGET_MS"))
+    {
+        double budget = std::atof(value);
+        if (budget > 0.0)
+        {
+            state().budgetMs = budget;
+        }
+    }
+    enabled = enable;
+    if (enable)
+    {
+        SetThreadName("main");
+        TraceLog(LOG_INFO, "TRACE: Recording, frames over %.1f ms are dumped", state().budgetMs);
+    }
+}
+
+// Only remembered while tracing is off; the buffer is taken on the first recorded event
+void TraceRecorder::SetThreadName(const char* name)
+{
+    threadOwner.name = name;
+    if (!IsEnabled())
+    {
+        return;
+    }
+    ThreadBuffer& buffer = currentBuffer();
+    std::lock_guard<std::mutex> lock(state().mutex);
+    buffer.name = name;
+}
+
+void TraceRecorder::Record(const char* name, Clock::time_point start, Clock::time_point end)
+{
+    ThreadBuffer& buffer = currentBuffer();
+    uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    TraceSlot& slot = buffer.slots[index % eventsPerThread];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(microseconds(start - state().epoch), std::memory_order_relaxed);
+    slot.duration.store(microseconds(end - start), std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+bool TraceRecorder::Dump(const std::string& path, double seconds)
+{
+    TraceState& trace = state();
+    int64_t since = microseconds(Clock::now() - trace.epoch) - static_cast<int64_t>(seconds * 1e6);
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+    {
+        TraceLog(LOG_WARNING, "TRACE: Could not write %s", path.c_str());
+        return false;
+    }
+    std::fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    for (auto& buffer : trace.buffers)
+    {
+        std::fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"%s\"}}",
+            first ? "" : ",\n", buffer->threadId, buffer->name.c_str());
+        first = false;
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t begin = (written > eventsPerThread) ? written - eventsPerThread : 0;
+        for (uint64_t index = begin; index < written; index++)
+        {
+            TraceSlot& slot = buffer->slots[index % eventsPerThread];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const char* name = slot.name.load(std::memory_order_relaxed);
+            int64_t start = slot.start.load(std::memory_order_relaxed);
+            int64_t duration = slot.duration.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ((sequence != 2 * index + 2) || (slot.sequence.load(std::memory_order_relaxed) != sequence) || (start < since))
+            {
+                continue;
+            }
+            std::fprintf(file, ",\n{\"ph\":\"X\",\"name\":\"%s\",\"pid\":1,\"tid\":%i,\"ts\":%lld,\"dur\":%lld}",
+                name, buffer->threadId, static_cast<long long>(start), static_cast<long long>(duration));
+        }
+    }
+    std::fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    std::fclose(file);
+    return true;
+}
+
+// Called once per frame from the main loop; rate limited so a slow machine does not
+// fill the disk with dumps
+void TraceRecorder::OnFrameEnd(double frameMs)
+{
+    TraceState& trace = state();
+    trace.frame++;
+    if (!IsEnabled() || (frameMs <= trace.budgetMs) || (trace.dumpCount >= maxDumps))
+    {
+        return;
+    }
+    auto now = Clock::now();
+    if ((trace.dumpCount > 0) && (std::chrono::duration<double>(now - trace.lastDump).count() < minSecondsBetweenDumps))
+    {
+        return;
+    }
+    trace.lastDump = now;
+    trace.dumpCount++;
+    std::string path = Profiler::OutputPath("trace_frame" + std::to_string(trace.frame) + ".json");
+    if (Dump(path, dumpSeconds))
+    {
+        TraceLog(LOG_WARNING, "TRACE: Frame %i took %.2f ms, wrote %s", trace.frame, frameMs, path.c_str());
+    }
+}
+#endif
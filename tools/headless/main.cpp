@@ -0,0 +1,292 @@
+#include "raylib.h"
+#include "bridge_designer.h"
+#include "bridge_evaluator.h"
+#include "input_recording.h"
+#include "job_system.h"
+#include "level.h"
+#include "level_data.h"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------
+// Headless level runner: builds a level without a window or GPU, adds the given
+// beams, drives the car and reports the outcome.
+//
+// usage: NextJam_headless <levels.ldtk|levels.bin> [--level N] [--steps N] [--workers N] [A:B ...]
+//        NextJam_headless <levels.ldtk|levels.bin> [--level N] [--threads N] [--timeout S] --batch <designs.txt>
+//        NextJam_headless <levels.ldtk|levels.bin> [--workers N] --replay <inputs.njir>
+//        NextJam_headless <levels.ldtk|levels.bin> [--level N|--all] [--threads N] [--population N]
+//                         [--generations N] [--seed N] [--max-span PX] [--out designs.txt] --design
+//
+// A designs file holds one bridge per line as space separated A:B node pairs.
+// An input recording is written by the game when NEXTJAM_RECORD is set.
+// --design searches each level for the cheapest passing bridge; --out writes them one
+// per line in level order, the --batch format.
+//----------------------------------------------------------------------------------
+
+static const char* StateName(scene::LevelState state)
+{
+    switch (state)
+    {
+        case scene::LevelState::PASSED: return "passed";
+        case scene::LevelState::LOSE: return "lose";
+        default: return "timeout";
+    }
+}
+
+static bool ParseJoint(const char* text, std::pair<int, int>& joint)
+{
+    return sscanf(text, "%i:%i", &joint.first, &joint.second) == 2;
+}
+
+static bool LoadDesigns(const char* fileName, std::vector<scene::BridgeDesign>& designs)
+{
+    std::ifstream file(fileName);
+    if (!file)
+    {
+        printf("cannot open designs file '%s'\n", fileName);
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        scene::BridgeDesign design;
+        std::istringstream tokens(line);
+        std::string token;
+        while (tokens >> token)
+        {
+            std::pair<int, int> joint;
+            if (!ParseJoint(token.c_str(), joint))
+            {
+                printf("invalid joint '%s' in '%s'\n", token.c_str(), fileName);
+                return false;
+            }
+            design.joints.push_back(joint);
+        }
+        if (!line.empty())
+        {
+            designs.emplace_back(std::move(design));
+        }
+    }
+    return true;
+}
+
+static int RunBatch(const scene::LevelData& data, int levelIndex, const char* fileName, scene::EvaluatorOptions options)
+{
+    std::vector<scene::BridgeDesign> designs;
+    if (!LoadDesigns(fileName, designs))
+    {
+        return 1;
+    }
+
+    scene::BridgeEvaluator evaluator(data, options);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<scene::BridgeResult> results = evaluator.EvaluateAll(designs);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    int passed = 0;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const scene::BridgeResult& result = results[i];
+        if (result.outcome == scene::LevelState::PASSED) passed++;
+        printf("design=%zu level=%i outcome=%s steps=%i time=%.3f\n", i, levelIndex,
+            result.valid? StateName(result.outcome) : "invalid", result.steps, result.timeToGoal);
+    }
+    double perSecond = (elapsed.count() > 0.0)? results.size()/elapsed.count() : 0.0;
+    printf("evaluated %zu designs (%i passed) in %.3f s on %i threads: %.0f per minute, %.1f per second per thread\n",
+        results.size(), passed, elapsed.count(), evaluator.GetThreadCount(), perSecond*60.0,
+        perSecond/evaluator.GetThreadCount());
+    return 0;
+}
+
+static int RunDesign(const scene::LevelProject& project, int firstLevel, int lastLevel, const char* outFile, scene::DesignerOptions options)
+{
+    std::ofstream out;
+    if (outFile)
+    {
+        out.open(outFile, std::ios::trunc);
+        if (!out)
+        {
+            printf("cannot write designs file '%s'\n", outFile);
+            return 1;
+        }
+    }
+
+    int unsolved = 0;
+    scene::DesignerStats total;
+    for (int levelIndex = firstLevel; levelIndex <= lastLevel; levelIndex++)
+    {
+        scene::BridgeDesigner designer(project.Get(levelIndex), options);
+        scene::DesignCandidate best = designer.Run();
+        const scene::DesignerStats& stats = designer.Stats();
+        bool passed = best.result.outcome == scene::LevelState::PASSED;
+        unsolved += passed? 0 : 1;
+
+        std::string joints;
+        for (auto& joint : best.design.joints)
+        {
+            joints += (joints.empty()? "" : " ") + std::to_string(joint.first) + ":" + std::to_string(joint.second);
+        }
+        printf("level=%i outcome=%s beams=%zu peak_error=%.2f progress=%.2f candidates=%zu generations=%i\n", levelIndex,
+            best.result.valid? StateName(best.result.outcome) : "invalid", best.design.joints.size(), best.result.peakJointError,
+            best.result.progress, designer.Candidates().size(), stats.generations);
+        printf("  %s\n", joints.c_str());
+        if (out)
+        {
+            out << joints << "\n";
+        }
+
+        total.evaluations += stats.evaluations;
+        total.cacheHits += stats.cacheHits;
+        total.steps += stats.steps;
+        total.seconds += stats.seconds;
+        total.threadCount = stats.threadCount;
+    }
+
+    double perSecond = (total.seconds > 0.0)? total.evaluations/total.seconds : 0.0;
+    double stepsPerSecond = (total.seconds > 0.0)? total.steps/total.seconds : 0.0;
+    printf("searched %i levels (%i unsolved): %i evaluations (%i cached) in %.2f s on %i threads\n",
+        lastLevel - firstLevel + 1, unsolved, total.evaluations, total.cacheHits, total.seconds, total.threadCount);
+    printf("%.1f evaluations per second, %.2f per second per thread, %.0f steps per second per thread\n",
+        perSecond, perSecond/total.threadCount, stepsPerSecond/total.threadCount);
+    return (unsolved == 0)? 0 : 2;
+}
+
+static int RunReplay(const scene::LevelProject& project, const char* fileName, int workerCount)
+{
+    scene::InputRecording recording;
+    if (!recording.Load(fileName))
+    {
+        printf("cannot load input recording '%s'\n", fileName);
+        return 1;
+    }
+
+    core::JobSystem jobSystem(workerCount);
+    auto start = std::chrono::steady_clock::now();
+    scene::ReplayResult result = scene::ReplayInputs(project, recording, &jobSystem);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (!result.valid)
+    {
+        printf("recording '%s' does not match these levels\n", fileName);
+        return 1;
+    }
+
+    double perSecond = (elapsed.count() > 0.0)? result.totalSteps/elapsed.count() : 0.0;
+    printf("replayed %zu inputs: level=%i step=%i checksum=%016llx expected=%016llx %s\n",
+        recording.Events().size(), result.finalLevel, result.finalStep,
+        (unsigned long long)result.checksum, (unsigned long long)recording.GetFinalChecksum(),
+        result.matches? "match" : "MISMATCH");
+    printf("%i steps in %.3f s: %.0f steps per second (%.1fx real time)\n", result.totalSteps, elapsed.count(),
+        perSecond, perSecond*scene::Level::fixedTimeStep);
+    return result.matches? 0 : 3;
+}
+
+int main(int argc, char** argv)
+{
+    SetTraceLogLevel(LOG_WARNING);
+    if (argc < 2)
+    {
+        printf("usage: %s <levels.ldtk|levels.bin> [--level N] [--steps N] [--workers N] [A:B ...]\n", argv[0]);
+        printf("       %s <levels.ldtk|levels.bin> [--level N] [--threads N] [--timeout S] --batch <designs.txt>\n", argv[0]);
+        printf("       %s <levels.ldtk|levels.bin> [--workers N] --replay <inputs.njir>\n", argv[0]);
+        printf("       %s <levels.ldtk|levels.bin> [--level N|--all] [--threads N] [--population N] [--generations N] [--seed N] [--max-span PX] [--out designs.txt] --design\n", argv[0]);
+        return 1;
+    }
+
+    scene::LevelProject project;
+    const char* extension = GetFileExtension(argv[1]);
+    bool loaded = (extension && (strcmp(extension, ".bin") == 0))? project.LoadFromBinary(argv[1]) : project.LoadFromLdtk(argv[1]);
+    if (!loaded)
+    {
+        printf("cannot load levels from '%s'\n", argv[1]);
+        return 1;
+    }
+
+    int levelIndex = 0;
+    int maxSteps = 60*60;
+    int workerCount = 1;
+    const char* batchFile = nullptr;
+    const char* replayFile = nullptr;
+    const char* outFile = nullptr;
+    bool design = false;
+    bool allLevels = false;
+    scene::EvaluatorOptions options;
+    scene::DesignerOptions designer;
+    std::vector<const char*> joints;
+    for (int i = 2; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--level") == 0) && (i + 1 < argc)) levelIndex = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--steps") == 0) && (i + 1 < argc)) maxSteps = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--workers") == 0) && (i + 1 < argc)) workerCount = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--threads") == 0) && (i + 1 < argc)) options.threadCount = designer.evaluator.threadCount = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--timeout") == 0) && (i + 1 < argc)) options.timeout = designer.evaluator.timeout = (float)atof(argv[++i]);
+        else if ((strcmp(argv[i], "--population") == 0) && (i + 1 < argc)) designer.population = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--generations") == 0) && (i + 1 < argc)) designer.generations = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--seed") == 0) && (i + 1 < argc)) designer.seed = (unsigned int)atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--max-span") == 0) && (i + 1 < argc)) designer.maxSpan = (float)atof(argv[++i]);
+        else if ((strcmp(argv[i], "--out") == 0) && (i + 1 < argc)) outFile = argv[++i];
+        else if (strcmp(argv[i], "--design") == 0) design = true;
+        else if (strcmp(argv[i], "--all") == 0) allLevels = true;
+        else if ((strcmp(argv[i], "--batch") == 0) && (i + 1 < argc)) batchFile = argv[++i];
+        else if ((strcmp(argv[i], "--replay") == 0) && (i + 1 < argc)) replayFile = argv[++i];
+        else joints.push_back(argv[i]);
+    }
+    if (replayFile)
+    {
+        return RunReplay(project, replayFile, workerCount);
+    }
+    if (design && allLevels)
+    {
+        return RunDesign(project, 0, project.Count() - 1, outFile, designer);
+    }
+    if ((levelIndex < 0) || (levelIndex >= project.Count()))
+    {
+        printf("level %i out of range (%i levels)\n", levelIndex, project.Count());
+        return 1;
+    }
+    if (batchFile)
+    {
+        return RunBatch(project.Get(levelIndex), levelIndex, batchFile, options);
+    }
+    if (design)
+    {
+        return RunDesign(project, levelIndex, levelIndex, outFile, designer);
+    }
+
+    core::JobSystem jobSystem(workerCount);
+    scene::Level level;
+    level.SetJobSystem(&jobSystem);
+    level.Build(project.Get(levelIndex));
+    for (const char* text : joints)
+    {
+        std::pair<int, int> joint;
+        if (!ParseJoint(text, joint) || !level.AddJoint(joint.first, joint.second))
+        {
+            printf("invalid joint '%s'\n", text);
+            return 1;
+        }
+    }
+
+    level.MoveCar();
+    int step = 0;
+    long long awakeBodies = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (; (step < maxSteps) && (level.GetState() == scene::LevelState::PLAYING); step++)
+    {
+        level.Step(scene::Level::fixedTimeStep, scene::Level::defaultSubStepCount);
+        awakeBodies += level.GetAwakeBodyCount();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    printf("level=%i outcome=%s steps=%i time=%.3f step_ms=%.3f awake=%.1f/%i\n", levelIndex, StateName(level.GetState()), step,
+        step*scene::Level::fixedTimeStep, (step > 0)? elapsed.count()/step : 0.0, (step > 0)? (double)awakeBodies/step : 0.0,
+        level.JointBodies().Size() + (level.GetCar().IsSpawned()? 3 : 0));
+    return (level.GetState() == scene::LevelState::PASSED)? 0 : 2;
+}
@@ -0,0 +1,34 @@
+#include "raylib.h"
+#include "level_data.h"
+
+#include <stdio.h>
+
+//----------------------------------------------------------------------------------
+// Offline level compiler: turns the LDtk project into the compact levels.bin that the
+// game maps at startup instead of parsing the JSON.
+//
+// usage: NextJam_levelc <levels.ldtk> <levels.bin>
+//----------------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    SetTraceLogLevel(LOG_WARNING);
+    if (argc != 3)
+    {
+        printf("usage: %s <levels.ldtk> <levels.bin>\n", argv[0]);
+        return 1;
+    }
+
+    scene::LevelProject project;
+    if (!project.LoadFromLdtk(argv[1]))
+    {
+        return 1;
+    }
+    if (!project.SaveBinary(argv[2]))
+    {
+        printf("cannot write '%s'\n", argv[2]);
+        return 1;
+    }
+    printf("compiled %i levels into %s\n", project.Count(), argv[2]);
+    return 0;
+}
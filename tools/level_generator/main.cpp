@@ -0,0 +1,88 @@
+#include "raylib.h"
+#include "level_data.h"
+#include "stress_level.h"
+
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------
+// Stress level generator: writes a levels.bin with one generated level per node count,
+// plus a designs file per level holding the bridge that spans it, for scaling runs of
+// the game, NextJam_headless and NextJam_bench.
+//
+// usage: NextJam_levelgen <stress.bin> [--rows N] [--spacing PX] [--seed N] [--no-tiles] [NODES ...]
+//
+// Level i's bridge goes to <stress>_bridge<i>.txt:
+//   NextJam_headless stress.bin --level i --batch stress_bridge<i>.txt
+//----------------------------------------------------------------------------------
+
+static bool WriteDesign(const std::string& fileName, const scene::BridgeDesign& design)
+{
+    std::ofstream file(fileName, std::ios::trunc);
+    for (size_t i = 0; i < design.joints.size(); i++)
+    {
+        file << (i ? " " : "") << design.joints[i].first << ":" << design.joints[i].second;
+    }
+    file << "\n";
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char** argv)
+{
+    SetTraceLogLevel(LOG_WARNING);
+    if (argc < 2)
+    {
+        printf("usage: %s <stress.bin> [--rows N] [--spacing PX] [--seed N] [--no-tiles] [NODES ...]\n", argv[0]);
+        return 1;
+    }
+
+    scene::StressLevelOptions options;
+    std::vector<int> nodeCounts;
+    for (int i = 2; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--rows") == 0) && (i + 1 < argc)) options.rows = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--spacing") == 0) && (i + 1 < argc)) options.spacing = (float)atof(argv[++i]);
+        else if ((strcmp(argv[i], "--seed") == 0) && (i + 1 < argc)) options.seed = (unsigned int)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--no-tiles") == 0) options.tiles = false;
+        else nodeCounts.push_back(atoi(argv[i]));
+    }
+    if (nodeCounts.empty())
+    {
+        nodeCounts = { 250, 500, 1000, 2000, 4000 };
+    }
+
+    std::string output = argv[1];
+    std::string stem = output.substr(0, output.rfind('.'));
+    scene::LevelProject project;
+    for (size_t i = 0; i < nodeCounts.size(); i++)
+    {
+        options.nodeCount = nodeCounts[i];
+        scene::StressLevel level = scene::GenerateStressLevel(options);
+        size_t tiles = 0;
+        for (auto& layer : level.data.tileLayers)
+        {
+            tiles += layer.tiles.size();
+        }
+        std::string designFile = stem + "_bridge" + std::to_string(i) + ".txt";
+        if (!WriteDesign(designFile, level.bridge))
+        {
+            printf("cannot write '%s'\n", designFile.c_str());
+            return 1;
+        }
+        printf("level=%zu size=%.0fx%.0f nodes=%zu beams=%zu statics=%zu terrain=%zu tiles=%zu bridge=%s\n", i,
+            level.data.size.x, level.data.size.y, level.data.nodes.size(), level.bridge.joints.size(),
+            level.data.statics.size(), level.data.terrain.size(), tiles, designFile.c_str());
+        project.Add(std::move(level.data));
+    }
+    if (!project.SaveBinary(output))
+    {
+        printf("cannot write '%s'\n", output.c_str());
+        return 1;
+    }
+    printf("generated %i levels into %s\n", project.Count(), output.c_str());
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "raylib.h"
+#include "resource_pack.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------
+// Resource packer: bundles every file of the resource directory into resources.pak,
+// which the game maps at startup instead of opening each asset on its own.
+//
+// usage: NextJam_pack <resources dir> <resources.pak> [--store .ext] [--skip .ext] [--add file]
+//
+// Entries are deflated when that saves at least an eighth, except the extensions kept
+// stored so the game can use them in place: .bin (levels are decoded from the mapping)
+// and streamed music (.mp3, .ogg). --store adds an extension to that list, --skip
+// leaves files out of the pack (e.g. the LDtk source once levels.bin is built), --add
+// packs a file from elsewhere at the root under its own name (the build's levels.bin).
+//----------------------------------------------------------------------------------
+
+static bool AddSource(std::vector<core::PackSource>& sources, const std::string& path, const std::string& name, bool compress)
+{
+    int size = 0;
+    unsigned char* data = LoadFileData(path.c_str(), &size);
+    if (!data && (size != 0))
+    {
+        printf("cannot read '%s'\n", path.c_str());
+        return false;
+    }
+    core::PackSource source;
+    source.name = name;
+    source.data.assign(data, data + size);
+    source.compress = compress;
+    sources.emplace_back(std::move(source));
+    UnloadFileData(data);
+    return true;
+}
+
+static bool HasExtension(const std::vector<std::string>& extensions, const std::string& name)
+{
+    const char* extension = GetFileExtension(name.c_str());
+    return extension && (std::find(extensions.begin(), extensions.end(), extension) != extensions.end());
+}
+
+int main(int argc, char** argv)
+{
+    SetTraceLogLevel(LOG_WARNING);
+    if (argc < 3)
+    {
+        printf("usage: %s <resources dir> <resources.pak> [--store .ext] [--skip .ext] [--add file]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> stored = { ".bin", ".mp3", ".ogg" };
+    std::vector<std::string> skipped;
+    std::vector<std::string> added;
+    for (int i = 3; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--store") == 0) && (i + 1 < argc)) stored.push_back(argv[++i]);
+        else if ((strcmp(argv[i], "--skip") == 0) && (i + 1 < argc)) skipped.push_back(argv[++i]);
+        else if ((strcmp(argv[i], "--add") == 0) && (i + 1 < argc)) added.push_back(argv[++i]);
+    }
+
+    std::string dir = argv[1];
+    while (!dir.empty() && ((dir.back() == '/') || (dir.back() == '\\')))
+    {
+        dir.pop_back();
+    }
+    std::vector<core::PackSource> sources;
+    FilePathList files = LoadDirectoryFilesEx(dir.c_str(), nullptr, true);
+    for (unsigned int i = 0; i < files.count; i++)
+    {
+        std::string path = files.paths[i];
+        std::string name = path.substr(dir.size() + 1);
+        std::replace(name.begin(), name.end(), '\\', '/');
+        if (!IsPathFile(path.c_str()) || HasExtension(skipped, name))
+        {
+            continue;
+        }
+        if (!AddSource(sources, path, name, !HasExtension(stored, name)))
+        {
+            UnloadDirectoryFiles(files);
+            return 1;
+        }
+    }
+    UnloadDirectoryFiles(files);
+    for (auto& path : added)
+    {
+        std::string name = GetFileName(path.c_str());
+        // An added file replaces a loose one of the same name
+        sources.erase(std::remove_if(sources.begin(), sources.end(), [&name](const core::PackSource& source) { return source.name == name; }), sources.end());
+        if (!AddSource(sources, path, name, !HasExtension(stored, name)))
+        {
+            return 1;
+        }
+    }
+    // Sorted so the same resources always give the same pack
+    std::sort(sources.begin(), sources.end(), [](const core::PackSource& a, const core::PackSource& b) { return a.name < b.name; });
+
+    if (!core::ResourcePack::Write(argv[2], sources))
+    {
+        printf("cannot write '%s'\n", argv[2]);
+        return 1;
+    }
+    size_t totalSize = 0;
+    size_t totalStored = 0;
+    for (auto& source : sources)
+    {
+        bool deflated = source.storedSize != source.data.size();
+        printf("  %-28s %10zu -> %10u %s\n", source.name.c_str(), source.data.size(), source.storedSize, deflated ? "deflate" : "stored");
+        totalSize += source.data.size();
+        totalStored += source.storedSize;
+    }
+    printf("packed %i files into %s: %zu -> %zu bytes\n", static_cast<int>(sources.size()), argv[2], totalSize, totalStored);
+    return 0;
+}